@@ -26,6 +26,7 @@ BOARD_VARS = \
 	USE_APP_CONFIG\
 	DEBUG\
 	DEBUG_NRF\
+	__HEAP_SIZE=0\
 
 # Default SDK source files to be included
 BOARD_SOURCES += \
@@ -35,7 +36,9 @@ BOARD_SOURCES += \
 	app_timer.c\
 	app_uart_fifo.c\
 	app_util_platform.c\
+	fds.c\
 	hardfault_handler_gcc.c\
+	nfc_platform.c\
 	nrf_assert.c\
 	nrf_atomic.c\
 	nrf_balloc.c\
@@ -44,6 +47,8 @@ BOARD_SOURCES += \
 	nrf_drv_uart.c\
 	nrf_fprintf.c\
 	nrf_fprintf_format.c\
+	nrf_fstorage.c\
+	nrf_fstorage_nvmc.c\
 	nrf_log_backend_rtt.c\
 	nrf_log_backend_serial.c\
 	nrf_log_default_backends.c\
@@ -61,6 +66,7 @@ BOARD_SOURCES += \
 	nrf_twi_mngr.c\
 	nrfx_clock.c\
 	nrfx_gpiote.c\
+	nrfx_nfct.c\
 	nrfx_ppi.c\
 	nrfx_prs.c\
 	nrfx_pwm.c\
@@ -72,6 +78,18 @@ BOARD_SOURCES += \
 	nrfx_uart.c\
 	nrfx_uarte.c\
 
+# NFC Type 4 Tag emulation library (precompiled in the SDK)
+LIBS += $(SDK_ROOT)components/nfc/t4t_lib/nfc_t4t_lib_gcc.a
+
+# No heap. The heap is reserved by gcc_startup_nrf52833.S, which only sees
+# assembler flags, so the size is passed to it directly as well as through
+# BOARD_VARS. `make memory` fails if the linked .heap section is not empty.
+ASMFLAGS += -D__HEAP_SIZE=0
+
+# Any call to the allocator from application or SDK code resolves
+# to an undefined __wrap_ symbol and fails to link
+LDFLAGS += -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free
+
 # Include the OpenOCD programming makefile
 # Replace the default JLink programming makefile from the nrf52x-base repo
 include $(BOARD_DIR)/../tools/openocd/Program_OpenOCD.mk
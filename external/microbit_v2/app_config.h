@@ -78,10 +78,19 @@
 
 #define CRC16_ENABLED 1
 
+// NFCT for the Type 4 Tag library. NFC1/NFC2 stay NFC pins, so do not
+// define CONFIG_NFCT_PINS_AS_GPIOS.
+#define NRFX_NFCT_ENABLED 1
+#define NFC_PLATFORM_ENABLED 1
+
 #define NRF_FSTORAGE_ENABLED 1
 #define FDS_ENABLED 1
 #define FDS_VIRTUAL_PAGES 10
 #define FDS_OP_QUEUE_SIZE 10
+// No SoftDevice, so FDS writes flash directly through the NVMC
+#define FDS_BACKEND 1
+// Records are not CRC-checked, so FDS needs no crc16 module
+#define FDS_CRC_CHECK_ON_READ 0
 
 #define MEM_MANAGER_ENABLED 1
 
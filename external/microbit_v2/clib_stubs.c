@@ -1,5 +1,8 @@
 // These are meaningless stub functions to satisfy the GCC linker
 
+#include <errno.h>
+#include <stddef.h>
+
 void _close() {}
 
 void _fstat() {}
@@ -12,3 +15,8 @@ void _kill() {}
 
 void _lseek() {}
 
+// There is no heap, so allocations inside newlib fail instead of growing into the stack
+void* _sbrk(ptrdiff_t incr) {
+  errno = ENOMEM;
+  return (void*)-1;
+}
@@ -0,0 +1,26 @@
+// Boot Phase Timing
+//
+// Records when each stage of start-up first completes, measured from the
+// start of main() on the microsecond clock, and reports the whole sequence
+// once the first settled BPM is on screen.
+
+#pragma once
+#include <stdint.h>
+
+typedef enum {
+  BOOT_PHASE_CLOCKS,            // app_timer, runtime and the microsecond clock
+  BOOT_PHASE_SENSORS,           // I2C, MAX30102
+  BOOT_PHASE_STORAGE,           // Session log
+  BOOT_PHASE_TASKS,             // Pulse pipelines, SAADC and task timers
+  BOOT_PHASE_DISPLAY,           // Display initialized and cleared
+  BOOT_PHASE_FIRST_SAMPLE,      // First SAADC scan processed
+  BOOT_PHASE_PROVISIONAL_BPM,   // Provisional BPM drawn
+  BOOT_PHASE_FIRST_BPM,         // Settled BPM drawn
+  BOOT_PHASE_COUNT,
+} boot_phase_t;
+
+void boot_init(void);
+
+void boot_mark(boot_phase_t phase);
+
+void boot_report(void);
@@ -1,17 +1,43 @@
 // TFT LCD with Touchscreen Breakout Display
+//
+// Commands and data are queued as SPIM transfers, each with its own D/C
+// level, and sent in order from the completion interrupt. Drawing returns as
+// soon as its transfers are queued; use fences to know when they are done.
 
 #pragma once
 #include <stdint.h>
+#include <stdbool.h>
 #include <stddef.h>
 
+// Transfers that can wait for the SPIM, including the one on the wire
+#define DISPLAY_XFER_QUEUE_SIZE 32
+
+// Payloads up to this size are copied into the queue
+#define DISPLAY_XFER_INLINE_MAX 16
+
 void spi_init(void);
 
-void display_init(void);
+// Called from the main loop when the display has been initialized
+typedef void (*display_ready_handler_t)(void);
+
+void display_init(display_ready_handler_t handler);
+
+bool display_is_ready(void);
 
 void spi_write_command(uint8_t cmd);
 
 void spi_write_data(uint8_t *data, size_t length);
 
+uint32_t display_fence(void);
+
+bool display_fence_reached(uint32_t fence);
+
+void display_flush(void);
+
+void display_pause(uint16_t ms);
+
+void display_transport_update(void);
+
 void fill_screen(uint16_t color);
 
 void write_text(char c, uint16_t color, uint16_t background, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
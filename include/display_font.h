@@ -8,9 +8,9 @@
 static const uint8_t font_rows = 95;
 static const uint8_t font_cols = 13;
 
-// Bit-map for display characters
+// Bit-map for display characters (const, so it stays in flash)
 // Source: https://courses.cs.washington.edu/courses/cse457/98a/tech/OpenGL/font.c
-uint8_t display_font[95][13] = {
+static const uint8_t display_font[95][13] = {
   {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, 
   {0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18}, 
   {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x36, 0x36, 0x36, 0x36}, 
@@ -0,0 +1,39 @@
+// Display Power Management
+//
+// The readings only change every few seconds, so the ILI9341 drops to 8-color
+// idle mode once the content has been static for a while, and sleeps when
+// there has been no valid reading for a minute. Display RAM is kept while
+// asleep, so waking up is sleep-out plus display-on with no re-initialization
+// or redraw.
+//
+// Partial mode is not used. Its area is a range of gate lines, and each text
+// line runs along them: the temperature line alone spans lines 0-298, so only
+// 21 of 320 lines could be left undriven without rotating the layout.
+
+#pragma once
+#include <stdint.h>
+
+// No change to the text on screen for this long switches to idle mode
+#define DISPLAY_IDLE_AFTER_MS 5000
+
+// No valid reading for this long puts the display to sleep
+#define DISPLAY_SLEEP_AFTER_MS 60000
+
+typedef enum {
+  DISPLAY_MODE_ACTIVE,   // Full color
+  DISPLAY_MODE_IDLE,     // 8 colors
+  DISPLAY_MODE_SLEEP,    // Sleep-in, panel off
+  DISPLAY_MODE_COUNT,
+} display_mode_t;
+
+void display_power_init(void);
+
+void display_power_wake(void);
+
+void display_power_changed(void);
+
+void display_power_activity(void);
+
+void display_power_update(void);
+
+display_mode_t display_power_mode(void);
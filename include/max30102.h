@@ -44,5 +44,11 @@ uint8_t max30102_get_sample_count(void);
 
 max30102_measurement_t max30102_read_sample(void);
 
+void max30102_start_temp(void);
+
 float max30102_read_temp(void);
 
+bool max30102_get_last_temp(int8_t* temp_int, uint8_t* temp_frac);
+
+void temperature_task(void);
+
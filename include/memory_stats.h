@@ -0,0 +1,25 @@
+// RAM Budget and Stack High-Water Mark
+//
+// Reads the RAM layout from the linker symbols: .data and .bss, the heap
+// (reserved size 0, see Board.mk) and the stack at the top of RAM. The
+// stack is painted with a known pattern at boot; the deepest word ever
+// overwritten is the high-water mark. main() and every interrupt handler run
+// on the one main stack (MSP), so the mark covers the deepest interrupt
+// nesting on top of the deepest main loop call.
+
+#pragma once
+#include <stdint.h>
+
+typedef struct {
+  uint32_t static_bytes;      // .data + .bss
+  uint32_t heap_bytes;        // Reserved heap
+  uint32_t unused_bytes;      // Between the heap and the stack limit
+  uint32_t stack_bytes;       // Stack size
+  uint32_t high_water_bytes;  // Deepest stack use since boot
+} memory_stats_t;
+
+void memory_stats_init(void);
+
+memory_stats_t memory_stats_get(void);
+
+void memory_stats_update(void);
@@ -0,0 +1,50 @@
+// Runtime Metrics and Instrumentation
+
+#pragma once
+#include <stdint.h>
+
+// Metrics published by the firmware modules
+typedef enum {
+  METRIC_CPU_LOAD_PERMILLE,         // Share of the last window spent awake (0-1000)
+  METRIC_WAKEUPS_PER_SEC,           // Wake-ups from sleep per second in the last window
+  METRIC_EVENTS_DROPPED,            // Events lost because an event or sample queue was full
+  METRIC_TASK_OVERRUNS,             // Task runs that completed after their deadline
+  METRIC_LOG_RECORDS_WRITTEN,       // Session log records written to flash
+  METRIC_LOG_READINGS_DROPPED,      // Readings lost: both record buffers busy, or the log full
+  METRIC_LOG_SCANS_PAUSED,          // Pulse scans skipped while the flash was written or erased
+  METRIC_LOG_FULL,                  // 1 once the current session filled the flash and logging stopped
+  METRIC_TELEMETRY_BYTES_SENT,      // Bytes transmitted on the telemetry UARTE
+  METRIC_TELEMETRY_PACKETS_DROPPED, // Packets dropped because both buffers were full
+  METRIC_SQI_SCORE,                 // Signal quality of the last window (0-100)
+  METRIC_SQI_LOW_WINDOWS,           // Windows scored below the quality threshold
+  METRIC_SQI_BPM_SKIPPED,           // BPM updates skipped for low quality
+  METRIC_SQI_REDRAWS_SKIPPED,       // Estimate redraws skipped for low quality
+  METRIC_SQI_LOG_SKIPPED,           // Low-quality readings with no temperature, not logged
+  METRIC_DISPLAY_ACTIVE_MS,         // Time the display has been on in full color
+  METRIC_DISPLAY_IDLE_MS,           // Time the display has been in 8-color idle mode
+  METRIC_DISPLAY_SLEEP_MS,          // Time the display has been asleep
+  METRIC_BOOT_PROVISIONAL_MS,       // Boot to the first provisional BPM on screen
+  METRIC_BOOT_FIRST_BPM_MS,         // Boot to the first settled BPM on screen
+  METRIC_NFC_FIELD_ON,              // Times an NFC reader field was detected
+  METRIC_NFC_NDEF_READS,            // NDEF messages read from the NFC tag
+  METRIC_NFC_BYTES_PATCHED,         // NDEF bytes changed by NFC tag updates
+  METRIC_DISPLAY_BUS_PERMILLE,      // Share of the last window the display SPI bus was busy (0-1000)
+  METRIC_DISPLAY_OVERLAP_PERMILLE,  // Share of display bus time the CPU spent on other work (0-1000)
+  METRIC_RAM_STATIC_BYTES,          // RAM in .data and .bss
+  METRIC_RAM_HEAP_BYTES,            // RAM reserved for the heap (should be 0)
+  METRIC_RAM_UNUSED_BYTES,          // RAM between the heap and the stack, free for new buffers
+  METRIC_STACK_SIZE_BYTES,          // Main stack size, shared by main() and interrupts
+  METRIC_STACK_HIGH_WATER_BYTES,    // Deepest main stack use seen since boot
+  METRIC_STACK_HEADROOM_BYTES,      // Main stack never touched since boot
+  METRIC_LOG_DELETE_FAILURES,       // Failed deletes of the oldest session when flash was full
+  METRIC_DISPLAY_XFER_FAILED,       // Display transfers the SPIM refused, dropped
+  METRIC_COUNT,
+} metric_id_t;
+
+void metrics_set(metric_id_t id, uint32_t value);
+
+void metrics_add(metric_id_t id, uint32_t delta);
+
+uint32_t metrics_get(metric_id_t id);
+
+void metrics_report(void);
@@ -0,0 +1,40 @@
+// NDEF Message with Live Readings
+//
+// Lays out an NFC Forum Type 4 Tag NDEF file (2-byte big-endian NLEN, then
+// the message) once, with three well-known Text records:
+//
+//   Heart rate:  72 bpm
+//   Temperature:  33.1 C
+//   Last 5 min: min  64 mean  71 max  79 bpm
+//
+// Every value has a fixed width, so record and message lengths never change.
+// Updates format the new value and write only the bytes that differ, in
+// place; nothing is rebuilt after ndef_tag_init(). The file is the buffer
+// the tag library serves to readers.
+
+#pragma once
+#include <stdint.h>
+#include "trends.h"
+
+// Capacity of the NDEF file, including NLEN
+#define NDEF_TAG_FILE_SIZE 112
+
+// Temperature value meaning "no reading"
+#define NDEF_TAG_NO_TEMP INT16_MIN
+
+typedef struct {
+  uint8_t file[NDEF_TAG_FILE_SIZE];
+  uint16_t size;            // Bytes in use, including NLEN
+  uint16_t bpm_field;       // File offsets of the patchable values
+  uint16_t temp_field;
+  uint16_t trend_field;
+  uint32_t bytes_patched;   // Bytes changed by updates since init
+} ndef_tag_t;
+
+void ndef_tag_init(ndef_tag_t* tag);
+
+uint8_t ndef_tag_set_bpm(ndef_tag_t* tag, uint32_t bpm);
+
+uint8_t ndef_tag_set_temp(ndef_tag_t* tag, int16_t temp_centi);
+
+uint8_t ndef_tag_set_trend(ndef_tag_t* tag, trend_stat_t const* bpm);
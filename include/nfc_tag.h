@@ -0,0 +1,17 @@
+// NFC Tag with Live Readings
+//
+// Emulates an NFC Forum Type 4 Tag on the NFCT peripheral. Phones read the
+// current BPM, temperature and 5-minute BPM trend as NDEF Text records (see
+// ndef_tag.h). The tag library serves reads straight from the NDEF file, and
+// each update patches only the bytes that changed.
+//
+// The antenna connects to edge pins P8 (NFC2) and P9 (NFC1), which are then
+// unavailable as GPIOs.
+
+#pragma once
+#include <stdint.h>
+#include "trends.h"
+
+void nfc_tag_init(void);
+
+void nfc_tag_update(uint32_t bpm, int16_t temp_centi, trend_stat_t const* bpm_trend);
@@ -0,0 +1,44 @@
+// Lossless PPG Sample Codec
+//
+// Streaming codec for slowly varying sensor signals. Each frame of up to
+// PPG_CODEC_FRAME_SAMPLES samples picks the best fixed linear predictor
+// (order 0-2) and Rice-codes the prediction residuals. Frames decode
+// independently, so a lost frame or flash record never corrupts the next one.
+// Encoder and decoder use constant memory and no heap.
+//
+// Frame layout (bit-packed, MSB first):
+//   6 bits  sample count - 1
+//   2 bits  predictor order
+//   5 bits  Rice parameter k
+//   order x (sample_bits + 1) bits  warm-up samples (zigzag)
+//   residuals: unary quotient, k remainder bits (escaped if the quotient is large)
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Samples per frame
+#define PPG_CODEC_FRAME_SAMPLES 64
+
+// Worst-case encoded frame size for the given sample width
+#define PPG_CODEC_MAX_FRAME_BYTES(sample_bits) \
+  (2 + (PPG_CODEC_FRAME_SAMPLES * (24 + (sample_bits) + 3) + 7) / 8)
+
+// Streaming encoder state
+typedef struct {
+  int32_t frame[PPG_CODEC_FRAME_SAMPLES];
+  uint16_t count;
+  uint8_t sample_bits;  // 12 for SAADC samples, 18 for MAX30102 red/IR
+} ppg_encoder_t;
+
+void ppg_encoder_init(ppg_encoder_t* enc, uint8_t sample_bits);
+
+size_t ppg_encoder_push(ppg_encoder_t* enc, int32_t sample, uint8_t* out, size_t out_size);
+
+size_t ppg_encoder_flush(ppg_encoder_t* enc, uint8_t* out, size_t out_size);
+
+size_t ppg_encode_frame(int32_t const* samples, uint16_t count, uint8_t sample_bits,
+                        uint8_t* out, size_t out_size);
+
+size_t ppg_decode_frame(uint8_t const* in, size_t in_size, uint8_t sample_bits,
+                        int32_t* samples, uint16_t* count);
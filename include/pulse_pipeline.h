@@ -0,0 +1,135 @@
+// Pulse Processing Pipeline
+//
+// Per-sensor processing state: moving-average filter, threshold peak
+// detection, signal quality and a beat-by-beat BPM estimate. Beat times come
+// from the microsecond timestamp of each sample, refined to a fraction of a
+// sample by fitting a parabola through the filtered maximum and the samples
+// PULSE_PEAK_FIT_SPAN either side of it. On every beat the BPM is re-estimated
+// from the median of the last few beat-to-beat (RR) intervals, with intervals
+// far from the median (missed or extra beats) rejected, and a confidence band
+// from their spread. Each sensor channel owns one pulse_pipeline_t, so any
+// number of sensors can be processed independently. Pure C with no SDK
+// dependency, so it also builds on the host.
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "signal_quality.h"
+
+// Time between samples fed to the pipeline
+#define PULSE_SAMPLE_INTERVAL_MS 2
+
+// Moving average filter length, in samples
+#define PULSE_MA_WINDOW 10
+
+// RR intervals in the median. Three follows a change in rate within two beats
+// while still outvoting a single bad interval.
+#define PULSE_RR_WINDOW 3
+
+// RR intervals further than this from the median are rejected as outliers,
+// unless PULSE_RR_MAX_REJECTED in a row show the rate itself has changed
+#define PULSE_RR_OUTLIER_PERCENT 30
+#define PULSE_RR_MAX_REJECTED    3
+
+// RR intervals outside this range are never beats (30-240 BPM)
+#define PULSE_RR_MIN_US 250000
+#define PULSE_RR_MAX_US 2000000
+
+// Confidence at which an estimate is reported as the BPM
+#define PULSE_MIN_CONFIDENCE 70
+
+// Relative half-width of the confidence band at which confidence reaches 0
+#define PULSE_BAND_ZERO_CONFIDENCE 0.10f
+
+// Time for the sensor to settle after start. Beats are detected as soon as
+// the filter is full, but until then they only give a provisional BPM.
+#define PULSE_STABILIZATION_TIME_MS 5000
+
+// Peak detection thresholds
+#define PULSE_PEAK_THRESHOLD       2350.0f   // Must exceed to count as a peak
+#define PULSE_LOWER_THRESHOLD      2000.0f   // Must fall below before detecting a new peak
+#define PULSE_MIN_PEAK_INTERVAL_MS 650       // Time between valid peaks
+#define PULSE_NO_PEAK_TIMEOUT_MS   5000      // Reset the peak window after this long
+
+// Distance, in samples, from the maximum to the other two points of the
+// parabola. The top of a pulse is nearly flat over one sample, so adjacent
+// samples mostly fit noise.
+#define PULSE_PEAK_FIT_SPAN 8
+#define PULSE_PEAK_FIT_SAMPLES (2 * PULSE_PEAK_FIT_SPAN + 1)
+
+// Delay of the moving-average filter, removed from beat times
+#define PULSE_MA_DELAY_US ((PULSE_MA_WINDOW - 1) * PULSE_SAMPLE_INTERVAL_MS * 1000 / 2)
+
+// Events returned by pulse_pipeline_process()
+#define PULSE_EVENT_BEAT        0x01   // A beat ended; beat_time_us holds its peak
+#define PULSE_EVENT_SQI_WINDOW  0x02   // A signal quality window was scored
+#define PULSE_EVENT_ESTIMATE    0x04   // estimate changed (new beat or pulse lost)
+
+// Beat-by-beat BPM estimate
+typedef struct {
+  uint32_t beat_time_us;   // Beat that produced the estimate
+  float bpm;               // From the median RR interval, 0 when there is no pulse
+  float bpm_low;           // Approximate 95% confidence band
+  float bpm_high;
+  uint8_t confidence;      // 0-100, from the band width and intervals used
+  uint8_t intervals;       // RR intervals in the median
+} pulse_estimate_t;
+
+// Outcome of pulse_pipeline_update_bpm()
+typedef enum {
+  PULSE_BPM_SETTLING,      // Still in the stabilization period
+  PULSE_BPM_LOW_QUALITY,   // Signal quality too poor
+  PULSE_BPM_NO_PULSE,      // No estimate with enough confidence
+  PULSE_BPM_VALID,         // bpm holds the current estimate
+} pulse_bpm_status_t;
+
+typedef struct {
+  // Moving average filter
+  float ma_buffer[PULSE_MA_WINDOW];
+  uint32_t ma_sample_count;
+  float ma_sum;
+  float filtered;
+
+  // Recent filtered samples and their times, for peak interpolation
+  float recent[PULSE_PEAK_FIT_SAMPLES];
+  uint32_t recent_us[PULSE_PEAK_FIT_SAMPLES];
+  uint8_t recent_index;   // Oldest sample, overwritten next
+
+  // Peak detection
+  uint32_t last_peak_time;   // Rising edge of the last peak (ms)
+  bool peak_detected;
+  float peak_value;          // Highest maximum of the current peak
+  uint32_t peak_time_us;     // Its interpolated time
+
+  // Latest beat and the interval before it (0 if unknown)
+  bool have_beat;
+  uint32_t beat_time_us;
+  uint32_t rr_us;
+
+  // Accepted RR intervals, oldest first, and outliers rejected in a row
+  uint32_t rr_history[PULSE_RR_WINDOW];
+  uint8_t rr_count;
+  uint8_t rr_rejected;
+
+  pulse_estimate_t estimate;
+
+  // Sample-count time base
+  uint32_t elapsed_time_ms;
+
+  sqi_t sqi;
+
+  // BPM for logging, updated by pulse_pipeline_update_bpm(). 0 when there is
+  // no valid pulse.
+  uint32_t bpm;
+} pulse_pipeline_t;
+
+void pulse_pipeline_init(pulse_pipeline_t* pipeline);
+
+uint8_t pulse_pipeline_process(pulse_pipeline_t* pipeline, float raw_sample, uint32_t time_us);
+
+pulse_bpm_status_t pulse_pipeline_update_bpm(pulse_pipeline_t* pipeline);
+
+bool pulse_pipeline_settled(pulse_pipeline_t const* pipeline);
+
+void pulse_pipeline_gap(pulse_pipeline_t* pipeline);
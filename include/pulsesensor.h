@@ -3,8 +3,14 @@
 #include "nrfx_saadc.h"
 #pragma once
 
-void adc_init(void);
+// Pulse sensors sampled together in one SAADC scan (at most 4)
+#define PULSE_CHANNEL_COUNT 1
 
-float adc_sample_blocking(void); 
+// Called from the SAADC interrupt with one sample per channel, in channel order
+typedef void (*adc_scan_handler_t)(nrf_saadc_value_t const* samples);
 
-void saadc_event_callback(nrfx_saadc_evt_t const* _unused);
\ No newline at end of file
+void adc_init(adc_scan_handler_t handler);
+
+void adc_start_scan(void);
+
+void saadc_event_callback(nrfx_saadc_evt_t const* p_event);
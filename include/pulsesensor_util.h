@@ -1,11 +1,30 @@
-// Pulse Sensor's Timer and BPM Functions
+// Pulse Sensor's Sampling, BPM and Display Tasks
 
-#include "app_timer.h"
 #pragma once
+#include <stdint.h>
+#include "pulse_pipeline.h"
 
-void start_sample_timer(void);
+// Pulse sensor sampling period
+#define SAMPLE_INTERVAL_MS PULSE_SAMPLE_INTERVAL_MS
 
-void stop_sample_timer(void);
+// Handlers that can subscribe to BPM estimate updates
+#define PULSE_MAX_SUBSCRIBERS 4
 
-void sample_timer_callback(void * p_context);
+// Called from the main loop on every beat and when a channel loses its pulse
+typedef void (*pulse_estimate_handler_t)(uint8_t channel, pulse_estimate_t const* estimate);
 
+void pulse_processing_init(void);
+
+void pulse_subscribe(pulse_estimate_handler_t handler);
+
+void sample_task(void);
+
+void pulse_sampling_pause(void);
+
+void pulse_sampling_resume(void);
+
+void bpm_task(void);
+
+void display_task(void);
+
+void pulse_report_trends(void);
@@ -0,0 +1,31 @@
+// Event-driven Runtime with CPU Load Accounting
+//
+// Interrupts post events, the main loop runs their handlers to completion
+// through app_scheduler, and the CPU sleeps whenever the queue is empty.
+// High-rate producers (e.g. the SAADC) instead push into their own lock-free
+// SPSC queue, which the main loop drains between scheduler events.
+
+#pragma once
+#include <stdint.h>
+#include "app_scheduler.h"
+#include "spsc_queue.h"
+
+// Largest event payload that can be posted to the runtime
+#define RUNTIME_EVENT_MAX_SIZE 8
+
+// Events that can be queued while the main loop is busy (e.g. redrawing)
+#define RUNTIME_QUEUE_SIZE 32
+
+// Items run from each SPSC queue before scheduler events get another turn
+#define RUNTIME_DISPATCH_BUDGET 8
+
+// Length of each CPU load accounting window
+#define RUNTIME_STATS_WINDOW_MS 5000
+
+void runtime_init(void);
+
+ret_code_t runtime_post(app_sched_event_handler_t handler, void const* data, uint16_t size);
+
+void runtime_add_queue(spsc_drain_t drain);
+
+void runtime_run(void);
@@ -0,0 +1,28 @@
+// Session Log Reading Codec
+//
+// Each reading after the first of a record is stored as its difference from
+// the previous one: time, BPM and temperature deltas, each zigzag-mapped so
+// small magnitudes stay small and written as a varint (7 bits per byte, low
+// bits first). A steady reading every 3 s takes 3 bytes instead of 8. Pure C,
+// so the on-flash format can be checked on the host.
+
+#pragma once
+#include <stdint.h>
+
+// Temperature value used when no reading is available yet
+#define SESSION_LOG_NO_TEMP INT16_MIN
+
+// Largest encoding of one reading: a 5-byte time delta and 3-byte BPM and
+// temperature deltas
+#define SESSION_CODEC_MAX_BYTES 11
+
+// One logged reading
+typedef struct {
+  uint32_t time_s;      // Seconds since the session started
+  uint16_t bpm;         // 0 when no valid pulse was detected
+  int16_t temp_centi;   // Hundredths of a degree C, or SESSION_LOG_NO_TEMP
+} session_reading_t;
+
+uint8_t* session_codec_put(uint8_t* out, session_reading_t const* prev, session_reading_t const* reading);
+
+uint8_t const* session_codec_get(uint8_t const* in, uint8_t const* end, session_reading_t* reading);
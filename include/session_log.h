@@ -0,0 +1,34 @@
+// Append-only Flash Session Log
+//
+// Readings are delta/varint encoded into a RAM record buffer as they arrive.
+// Full buffers are written to flash through FDS by the storage task. The
+// NVMC stalls the CPU for about 10 ms per record and 85 ms per page erased
+// by garbage collection, so sampling pauses for each write; the scans lost
+// are counted in log_scans_paused. Each boot starts a new session,
+// stored as its own FDS file. A stored session can be exported over the
+// telemetry link, a few packets per storage task run.
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdk_common.h"
+#include "session_codec.h"
+
+// Flush a partially filled record once its oldest reading is this old,
+// bounding how much history a power loss can take with it
+#define SESSION_LOG_MAX_LATENCY_S 300
+
+// Readings per telemetry packet when exporting a session
+#define SESSION_LOG_EXPORT_READINGS 24
+
+void session_log_init(void);
+
+bool session_log_available(void);
+
+uint16_t session_log_current(void);
+
+void session_log_append(uint32_t time_s, uint16_t bpm, int16_t temp_centi);
+
+ret_code_t session_log_export(uint16_t session);
+
+void storage_task(void);
@@ -0,0 +1,62 @@
+// Signal Quality Index
+//
+// Scores each window of pulse samples from 0 to 100 using four cheap checks,
+// each worth up to 25 points:
+//   clipping     - share of samples stuck at the ADC rails (heavy clipping fails)
+//   amplitude    - peak-to-peak swing (too small means no finger on the sensor)
+//   periodicity  - consistency of recent beat-to-beat intervals
+//   morphology   - correlation of each beat with a running beat template
+// Per-sample work is a few comparisons; correlation runs once per beat.
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Samples per scored window (2 s at 500 Hz)
+#define SQI_WINDOW_SAMPLES 1000
+
+// Score at or above which downstream processing runs
+#define SQI_GOOD_THRESHOLD 70
+
+// Beat template: 32 points taken every 4th sample (256 ms before the beat)
+#define SQI_TEMPLATE_POINTS 32
+#define SQI_TEMPLATE_DECIMATION 4
+
+// Beat-to-beat intervals kept for the periodicity check
+#define SQI_RR_HISTORY 4
+
+typedef struct {
+  // Current window
+  uint16_t window_count;
+  uint16_t clipped;
+  float window_min;
+  float window_max;
+  uint8_t window_beats;
+
+  // Beat intervals
+  uint32_t last_beat_ms;
+  uint32_t rr_ms[SQI_RR_HISTORY];
+  uint8_t rr_count;
+
+  // Decimated history and beat template
+  float history[SQI_TEMPLATE_POINTS];
+  uint8_t history_index;
+  uint8_t decimation;
+  float template_points[SQI_TEMPLATE_POINTS];
+  bool template_valid;
+  float correlation;
+
+  // Result of the last completed window
+  uint8_t score;
+  uint8_t missed_windows;
+} sqi_t;
+
+void sqi_init(sqi_t* sqi);
+
+bool sqi_add_sample(sqi_t* sqi, float raw, float filtered);
+
+void sqi_add_beat(sqi_t* sqi, uint32_t time_ms);
+
+uint8_t sqi_score(sqi_t const* sqi);
+
+bool sqi_is_good(sqi_t const* sqi);
@@ -0,0 +1,130 @@
+// Lock-free Single-Producer Single-Consumer Queues
+//
+// Statically sized rings for handing items from one interrupt (or thread) to
+// the main loop without critical sections. The size must be a power of two;
+// head and tail run freely and are masked on access, so all slots are used
+// and a full ring is told apart from an empty one by head - tail == size.
+//
+// Only the producer writes head and only the consumer writes tail. Each side
+// publishes its index with a release store after touching the slot, and reads
+// the other side's index with an acquire load, so an item is never seen
+// before it is written nor overwritten before it is read. On the Cortex-M4
+// these compile to plain loads and stores with a DMB.
+//
+// A dispatcher drains several queues in priority order from one loop.
+//
+//   SPSC_QUEUE_DEFINE(scan_queue, pulse_scan_t, 64)
+//   static scan_queue_t scans;
+//   SPSC_QUEUE_DRAIN(drain_scans, scan_queue, scans, process_scan)
+//
+//   scan_queue_push(&scans, &scan);        // Producer (interrupt)
+//   spsc_dispatcher_add(&queues, drain_scans);
+//   spsc_dispatch(&queues, 8);             // Consumer (main loop)
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SPSC_LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define SPSC_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+// Define name_t, a ring of size items of type, and its inline operations:
+//   name_push(q, &item)  Producer: copy item in, false if full (counted)
+//   name_pop(q, &item)   Consumer: copy the oldest item out, false if empty
+//   name_front(q)        Consumer: oldest item in place, NULL if empty
+//   name_release(q)      Consumer: free the item returned by name_front
+//   name_count(q)        Either side: items waiting (a snapshot)
+#define SPSC_QUEUE_DEFINE(name, type, size)                                    \
+  _Static_assert((size) > 0 && ((size) & ((size) - 1)) == 0,                   \
+                 #name " size must be a power of two");                        \
+  typedef struct {                                                             \
+    uint32_t head;     /* Next slot to write, owned by the producer */         \
+    uint32_t tail;     /* Next slot to read, owned by the consumer */          \
+    uint32_t dropped;  /* Pushes refused because the ring was full */          \
+    type items[size];                                                          \
+  } name##_t;                                                                  \
+                                                                               \
+  static inline bool name##_push(name##_t* q, type const* item) {              \
+    uint32_t head = q->head;                                                   \
+    if (head - SPSC_LOAD_ACQUIRE(&q->tail) == (size)) {                        \
+      q->dropped++;                                                            \
+      return false;                                                            \
+    }                                                                          \
+    q->items[head & ((size) - 1)] = *item;                                     \
+    SPSC_STORE_RELEASE(&q->head, head + 1);                                    \
+    return true;                                                               \
+  }                                                                            \
+                                                                               \
+  static inline type* name##_front(name##_t* q) {                              \
+    uint32_t tail = q->tail;                                                   \
+    if (SPSC_LOAD_ACQUIRE(&q->head) == tail) {                                 \
+      return NULL;                                                             \
+    }                                                                          \
+    return &q->items[tail & ((size) - 1)];                                     \
+  }                                                                            \
+                                                                               \
+  static inline void name##_release(name##_t* q) {                             \
+    SPSC_STORE_RELEASE(&q->tail, q->tail + 1);                                 \
+  }                                                                            \
+                                                                               \
+  static inline bool name##_pop(name##_t* q, type* item) {                     \
+    type* front = name##_front(q);                                             \
+    if (front == NULL) {                                                       \
+      return false;                                                            \
+    }                                                                          \
+    *item = *front;                                                            \
+    name##_release(q);                                                         \
+    return true;                                                               \
+  }                                                                            \
+                                                                               \
+  static inline uint32_t name##_count(name##_t* q) {                           \
+    return SPSC_LOAD_ACQUIRE(&q->head) - SPSC_LOAD_ACQUIRE(&q->tail);          \
+  }
+
+// Define `static uint32_t drain(uint32_t budget)`, which passes up to budget
+// items from queue (of a type made by SPSC_QUEUE_DEFINE(name, ...)) to
+// `void handler(type const* item)` in place and returns how many it passed.
+#define SPSC_QUEUE_DRAIN(drain, name, queue, handler)                          \
+  static uint32_t drain(uint32_t budget) {                                     \
+    uint32_t handled = 0;                                                      \
+    while (handled < budget) {                                                 \
+      __typeof__((queue).items[0])* item = name##_front(&(queue));             \
+      if (item == NULL) {                                                      \
+        break;                                                                 \
+      }                                                                        \
+      handler(item);                                                           \
+      name##_release(&(queue));                                                \
+      handled++;                                                               \
+    }                                                                          \
+    return handled;                                                            \
+  }
+
+// Most queues one dispatcher can drain
+#define SPSC_DISPATCH_MAX_QUEUES 8
+
+// Runs up to budget items from one queue and returns how many it ran
+typedef uint32_t (*spsc_drain_t)(uint32_t budget);
+
+typedef struct {
+  spsc_drain_t drains[SPSC_DISPATCH_MAX_QUEUES];
+  uint8_t count;
+} spsc_dispatcher_t;
+
+// Add a queue; queues added first are drained first
+static inline bool spsc_dispatcher_add(spsc_dispatcher_t* dispatcher, spsc_drain_t drain) {
+  if (dispatcher->count >= SPSC_DISPATCH_MAX_QUEUES) {
+    return false;
+  }
+  dispatcher->drains[dispatcher->count++] = drain;
+  return true;
+}
+
+// Give every queue up to budget items, in priority order. Returns the number
+// of items run; call again until it returns 0 to empty every queue.
+static inline uint32_t spsc_dispatch(spsc_dispatcher_t* dispatcher, uint32_t budget) {
+  uint32_t handled = 0;
+  for (uint8_t i = 0; i < dispatcher->count; i++) {
+    handled += dispatcher->drains[i](budget);
+  }
+  return handled;
+}
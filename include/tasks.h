@@ -0,0 +1,46 @@
+// Cooperative Multi-rate Task Scheduler
+//
+// Every periodic job is an entry in a static task table with its own period,
+// priority and deadline. A single app_timer is re-armed for the next release,
+// so the timer only fires when some task is due. The 2 ms sample task is
+// always due, so in practice the timer fires and is re-armed every 2 ms and
+// the sample period sets the CPU wake rate.
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Task identifiers, also the index into the task table
+typedef enum {
+  TASK_SAMPLE,
+  TASK_BPM,
+  TASK_TEMPERATURE,
+  TASK_DISPLAY,
+  TASK_LOGGING,
+  TASK_STORAGE,
+  TASK_COUNT,
+} task_id_t;
+
+// Static task description
+typedef struct {
+  const char* name;
+  void (*run)(void);
+  uint32_t period_ms;
+  uint8_t priority;      // Lower values run first
+  uint32_t deadline_ms;  // Must complete within this long of its release
+  bool in_interrupt;     // Run directly from the timer interrupt (keep it short)
+} task_t;
+
+// Per-task runtime statistics
+typedef struct {
+  uint32_t runs;
+  uint32_t overruns;         // Completed after the deadline
+  uint32_t skipped;          // Released again before the previous run started
+  uint32_t max_response_ms;  // Worst release-to-completion time
+} task_stats_t;
+
+void tasks_init(void);
+
+void tasks_start(void);
+
+void tasks_report(void);
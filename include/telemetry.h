@@ -0,0 +1,49 @@
+// Binary Telemetry Stream over UARTE
+//
+// Packets are framed as COBS(type, seq, payload, CRC16) followed by a 0x00
+// delimiter (see telemetry_frame.h) and sent with EasyDMA. Frames are encoded
+// straight into one of two DMA buffers while the other is on the wire, so
+// payloads are never copied.
+// All multi-byte payload fields are little-endian.
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "microbit_v2.h"
+
+// Telemetry output pin (needs an external USB-serial adapter at 1 Mbaud)
+#define TELEMETRY_TX_PIN EDGE_P14
+
+// Size of each of the two DMA buffers
+#define TELEMETRY_BUFFER_SIZE 512
+
+// Raw PPG samples batched into one uncompressed packet (50 ms at 500 Hz)
+#define TELEMETRY_SAMPLES_PER_PACKET 25
+
+// Send raw PPG samples as lossless codec frames (see ppg_codec.h)
+#define TELEMETRY_COMPRESS_RAW 1
+
+// Packet types
+typedef enum {
+  TELEMETRY_PKT_RAW_SAMPLES = 0x01,  // u32 first sample index, u16 samples[]
+  TELEMETRY_PKT_RED_IR      = 0x02,  // u32 first sample index, {u32 red, u32 ir}[]
+  TELEMETRY_PKT_BEAT        = 0x03,  // u32 beat time (us), u16 bpm x10, u16 band x10, u8 confidence
+  TELEMETRY_PKT_VITALS      = 0x04,  // u16 bpm, u16 SpO2 (0.1 %), i16 temp (0.01 C), u8 quality
+  TELEMETRY_PKT_METRICS     = 0x05,  // {u8 metric id, u32 value}[]
+  TELEMETRY_PKT_RAW_CODED   = 0x06,  // u32 first sample index, 12-bit ppg_codec frame
+  TELEMETRY_PKT_SESSION     = 0x07,  // u16 session, u32 first reading index, {u32 time (s), u16 bpm, i16 temp (0.01 C)}[]; none ends the session
+} telemetry_packet_type_t;
+
+void telemetry_init(void);
+
+bool telemetry_send(telemetry_packet_type_t type, uint8_t const* payload, uint16_t length);
+
+void telemetry_raw_sample(uint16_t sample);
+
+void telemetry_red_ir(uint32_t first_index, uint32_t const* red, uint32_t const* ir, uint8_t count);
+
+void telemetry_beat(uint32_t time_us, uint16_t bpm_tenths, uint16_t band_tenths, uint8_t confidence);
+
+void telemetry_vitals(uint16_t bpm, uint16_t spo2_permille, int16_t temp_centi, uint8_t quality);
+
+void telemetry_metrics(void);
@@ -0,0 +1,24 @@
+// Telemetry Frame Encoding
+//
+// A frame is COBS(type, seq, payload, CRC16) followed by a 0x00 delimiter.
+// The CRC is CRC-16/CCITT-FALSE over type, seq and payload, little-endian.
+// Pure C, shared by the firmware and the host receiver, so the receiver's
+// simulation exercises the same encoder the board runs.
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Largest encoded frame for a payload length: type, seq and CRC, the worst
+// case COBS overhead of one byte per 254, and the delimiter
+#define TELEMETRY_FRAME_MAX_BYTES(length) \
+  ((2 + (length) + 2) + (2 + (length) + 2) / 254 + 2)
+
+uint16_t telemetry_crc16(uint8_t const* data, size_t size, uint16_t crc);
+
+size_t telemetry_frame_encode(uint8_t* out, uint8_t type, uint8_t seq, uint8_t const* payload, uint16_t length);
+
+// Little-endian field helpers
+uint8_t* telemetry_put_u16(uint8_t* out, uint16_t value);
+
+uint8_t* telemetry_put_u32(uint8_t* out, uint32_t value);
@@ -0,0 +1,15 @@
+// Microsecond Timestamps
+//
+// Free-running 32-bit TIMER1 at 1 MHz. Wraps every 71 minutes, so only
+// differences between nearby timestamps are meaningful.
+//
+// The timer runs from boot and keeps the high-frequency clock on between
+// samples, which costs about 250-500 uA over the RTC alone. That buys beat
+// times to the microsecond instead of the RTC's 30.5 us ticks.
+
+#pragma once
+#include <stdint.h>
+
+void timestamp_init(void);
+
+uint32_t timestamp_us(void);
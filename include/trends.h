@@ -0,0 +1,61 @@
+// Multi-resolution Rolling Statistics
+//
+// Keeps min, max, mean and count of each vital at four resolutions. Readings
+// go into a 10 s accumulator; every closed bucket is pushed into its level's
+// ring and merged into the next coarser accumulator, so each reading costs
+// O(1) amortized. Queries combine at most about 100 buckets from the coarsest
+// level that still resolves the requested span, never the raw readings.
+//
+//   level  bucket  buckets  span
+//   0      10 s    30       5 min
+//   1      1 min   60       1 h
+//   2      15 min  96       24 h
+//   3      1 h     24       24 h
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TRENDS_LEVELS 4
+#define TRENDS_TOTAL_BUCKETS (30 + 60 + 96 + 24)
+
+// Tracked vitals
+typedef enum {
+  TREND_BPM,    // Beats per minute
+  TREND_TEMP,   // Hundredths of a degree C
+  TREND_SPO2,   // Tenths of a percent
+  TREND_METRIC_COUNT,
+} trend_metric_t;
+
+// Closed bucket, also used for query results
+typedef struct {
+  int16_t min;
+  int16_t max;
+  int16_t mean;
+  uint16_t count;
+} trend_stat_t;
+
+// Bucket being filled
+typedef struct {
+  int32_t sum;
+  int16_t min;
+  int16_t max;
+  uint16_t count;
+} trend_accum_t;
+
+typedef struct {
+  trend_stat_t buckets[TRENDS_TOTAL_BUCKETS][TREND_METRIC_COUNT];
+  trend_accum_t accum[TRENDS_LEVELS][TREND_METRIC_COUNT];
+  uint16_t head[TRENDS_LEVELS];     // Next slot to write in each ring
+  uint16_t filled[TRENDS_LEVELS];   // Closed buckets held in each ring
+  uint32_t closed[TRENDS_LEVELS];   // Buckets closed since the start
+  uint32_t bucket_end_s;            // End of the current 10 s bucket
+} trends_t;
+
+void trends_init(trends_t* trends, uint32_t start_s);
+
+void trends_add(trends_t* trends, uint32_t time_s, trend_metric_t metric, int16_t value);
+
+void trends_advance(trends_t* trends, uint32_t time_s);
+
+bool trends_query(trends_t const* trends, trend_metric_t metric, uint32_t span_s, trend_stat_t* result);
@@ -0,0 +1,52 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "boot.h"
+#include "metrics.h"
+#include "timestamp.h"
+
+static const char* const phase_names[BOOT_PHASE_COUNT] = {
+  [BOOT_PHASE_CLOCKS]          = "clocks",
+  [BOOT_PHASE_SENSORS]         = "sensors",
+  [BOOT_PHASE_STORAGE]         = "storage",
+  [BOOT_PHASE_TASKS]           = "tasks",
+  [BOOT_PHASE_DISPLAY]         = "display",
+  [BOOT_PHASE_FIRST_SAMPLE]    = "first_sample",
+  [BOOT_PHASE_PROVISIONAL_BPM] = "provisional_bpm",
+  [BOOT_PHASE_FIRST_BPM]       = "first_bpm",
+};
+
+// Time each phase completed, in us since boot_init()
+static uint32_t phase_us[BOOT_PHASE_COUNT];
+static bool phase_done[BOOT_PHASE_COUNT];
+
+// Start the clock. Call first thing in main().
+void boot_init(void) {
+  timestamp_init();
+}
+
+// Record the first time a phase completes; later calls are ignored
+void boot_mark(boot_phase_t phase) {
+  if (phase_done[phase]) {
+    return;
+  }
+  phase_us[phase] = timestamp_us();
+  phase_done[phase] = true;
+
+  if (phase == BOOT_PHASE_PROVISIONAL_BPM) {
+    metrics_set(METRIC_BOOT_PROVISIONAL_MS, phase_us[phase] / 1000);
+  } else if (phase == BOOT_PHASE_FIRST_BPM) {
+    metrics_set(METRIC_BOOT_FIRST_BPM_MS, phase_us[phase] / 1000);
+    boot_report();
+  }
+}
+
+// Print the completed phases as "boot name=ms" lines
+void boot_report(void) {
+  for (int i = 0; i < BOOT_PHASE_COUNT; i++) {
+    if (phase_done[i]) {
+      printf("boot %s=%lu.%03lu ms\n", phase_names[i], phase_us[i] / 1000, phase_us[i] % 1000);
+    }
+  }
+}
@@ -3,15 +3,218 @@
 #include <stdio.h>
 #include <string.h>
 
-#include "nrf_delay.h"
+#include "app_error.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
 #include "nrfx_spim.h"
 #include "microbit_v2.h"
 #include "display.h"
 #include "display_font.h"
+#include "runtime.h"
+#include "spsc_queue.h"
+#include "timestamp.h"
+#include "metrics.h"
 
 // Create SPIM instance
 static const nrfx_spim_t spi = NRFX_SPIM_INSTANCE(2);
 
+// One pending transfer. Small payloads are copied in; larger ones are sent
+// from the caller's buffer.
+typedef struct {
+  uint8_t const* data;                     // NULL to send inline_data
+  uint16_t length;
+  uint16_t repeat;                         // Times to send the payload
+  uint16_t pause_ms;                       // Nonzero: hold the bus idle instead
+  bool dc;                                 // D/C level: true for data
+  uint8_t inline_data[DISPLAY_XFER_INLINE_MAX];
+} display_xfer_t;
+
+// Filled by the main loop, drained by the SPIM completion interrupt. The
+// transfer on the wire stays at the front until it completes.
+SPSC_QUEUE_DEFINE(xfer_queue, display_xfer_t, DISPLAY_XFER_QUEUE_SIZE)
+static xfer_queue_t xfers;
+static volatile bool bus_busy = false;
+
+// Transfers queued by the main loop and completed by the interrupt
+static uint32_t xfers_queued = 0;
+static volatile uint32_t xfers_completed = 0;
+
+// Bus and wait time in the current metrics window
+static uint32_t transfer_start_us = 0;
+static volatile uint32_t bus_busy_us = 0;
+static uint32_t cpu_wait_us = 0;
+static uint32_t window_start_us = 0;
+
+// Failed transfers already reported from the main loop
+static uint32_t xfers_failed_reported = 0;
+
+// Ends a queued pause
+APP_TIMER_DEF(m_pause_timer);
+
+// Start the transfer at the front of the queue, if any. Only called with
+// the bus idle: from the completion interrupt, or with interrupts disabled.
+static void start_next_transfer(void) {
+  display_xfer_t const* xfer;
+  while ((xfer = xfer_queue_front(&xfers)) != NULL) {
+    if (xfer->pause_ms > 0) {
+      // Nothing else goes out until the pause timer fires
+      if (app_timer_start(m_pause_timer, APP_TIMER_TICKS(xfer->pause_ms), NULL) == NRF_SUCCESS) {
+        bus_busy = true;
+        return;
+      }
+      metrics_add(METRIC_DISPLAY_XFER_FAILED, 1);
+      xfer_queue_release(&xfers);
+      xfers_completed++;
+      continue;
+    }
+
+    nrf_gpio_pin_write(EDGE_P12, xfer->dc);
+    nrfx_spim_xfer_desc_t desc = NRFX_SPIM_XFER_TX(xfer->data ? xfer->data : xfer->inline_data, xfer->length);
+    transfer_start_us = timestamp_us();
+    nrfx_err_t err = nrfx_spim_xfer(&spi, &desc, 0);
+    if (err == NRFX_SUCCESS) {
+      bus_busy = true;
+      return;
+    }
+
+    // Drop a transfer the SPIM refused, so nothing waits for it forever.
+    // This may run in the SPIM interrupt, so it is only counted here and
+    // reported from the main loop.
+    metrics_add(METRIC_DISPLAY_XFER_FAILED, 1);
+    xfer_queue_release(&xfers);
+    xfers_completed++;
+  }
+  bus_busy = false;
+}
+
+// Runs in the SPIM interrupt when a transfer is on the panel. Chains the
+// next one straight away.
+static void spim_handler(nrfx_spim_evt_t const* event, void* context) {
+  bus_busy_us += timestamp_us() - transfer_start_us;
+  display_xfer_t* xfer = xfer_queue_front(&xfers);
+  if (xfer->repeat > 1) {
+    xfer->repeat--;
+  } else {
+    xfer_queue_release(&xfers);
+    xfers_completed++;
+  }
+  start_next_transfer();
+}
+
+// Runs in the app_timer interrupt when a queued pause is over
+static void pause_timer_handler(void* p_context) {
+  CRITICAL_REGION_ENTER();
+  xfer_queue_release(&xfers);
+  xfers_completed++;
+  start_next_transfer();
+  CRITICAL_REGION_EXIT();
+}
+
+// Sleep until the completion interrupt has made progress, counting the time
+// the CPU spent waiting for the bus
+static void wait_for_bus(uint32_t completed) {
+  uint32_t start = timestamp_us();
+  while (xfers_completed == completed) {
+    __WFE();
+  }
+  cpu_wait_us += timestamp_us() - start;
+}
+
+// Queue a transfer and start the bus if it is idle. Waits for a free slot
+// when the queue is full.
+static void queue_transfer(display_xfer_t const* xfer) {
+  while (xfer_queue_count(&xfers) == DISPLAY_XFER_QUEUE_SIZE) {
+    wait_for_bus(xfers_completed);
+  }
+  xfer_queue_push(&xfers, xfer);
+  xfers_queued++;
+
+  CRITICAL_REGION_ENTER();
+  if (!bus_busy) {
+    start_next_transfer();
+  }
+  CRITICAL_REGION_EXIT();
+}
+
+// Queue a payload with its D/C level, sent repeat times. Payloads up to
+// DISPLAY_XFER_INLINE_MAX bytes are copied; larger ones must stay unchanged
+// until their fence is reached.
+static void queue_payload(bool dc, uint8_t const* data, size_t length, uint16_t repeat) {
+  display_xfer_t xfer = {
+    .data = NULL,
+    .length = (uint16_t)length,
+    .repeat = repeat,
+    .dc = dc,
+  };
+  if (length <= DISPLAY_XFER_INLINE_MAX) {
+    memcpy(xfer.inline_data, data, length);
+  } else {
+    xfer.data = data;
+  }
+  queue_transfer(&xfer);
+}
+
+// Queue a pause: transfers queued after it start at least ms later. Returns
+// at once, unlike a delay in the caller.
+void display_pause(uint16_t ms) {
+  if (ms == 0) {
+    return;
+  }
+  display_xfer_t xfer = {
+    .data = NULL,
+    .length = 0,
+    .repeat = 1,
+    .pause_ms = ms,
+  };
+  queue_transfer(&xfer);
+}
+
+// Fence covering every transfer queued so far
+uint32_t display_fence(void) {
+  return xfers_queued;
+}
+
+// Whether every transfer up to the fence is on the panel
+bool display_fence_reached(uint32_t fence) {
+  return (int32_t)(xfers_completed - fence) >= 0;
+}
+
+// Wait until every queued transfer is on the panel
+void display_flush(void) {
+  while (!display_fence_reached(xfers_queued)) {
+    wait_for_bus(xfers_completed);
+  }
+}
+
+// Publish bus utilization and how much of the bus time the CPU spent on other
+// work instead of waiting for it, over the time since the last call. Also
+// reports transfers the SPIM refused.
+void display_transport_update(void) {
+  uint32_t now = timestamp_us();
+  uint32_t elapsed = now - window_start_us;
+  uint32_t busy;
+  CRITICAL_REGION_ENTER();
+  busy = bus_busy_us;
+  bus_busy_us = 0;
+  CRITICAL_REGION_EXIT();
+  uint32_t waited = (cpu_wait_us < busy) ? cpu_wait_us : busy;
+
+  if (elapsed > 0) {
+    metrics_set(METRIC_DISPLAY_BUS_PERMILLE, (uint32_t)(((uint64_t)busy * 1000) / elapsed));
+  }
+  if (busy > 0) {
+    metrics_set(METRIC_DISPLAY_OVERLAP_PERMILLE, (uint32_t)(((uint64_t)(busy - waited) * 1000) / busy));
+  }
+  window_start_us = now;
+  cpu_wait_us = 0;
+
+  uint32_t failed = metrics_get(METRIC_DISPLAY_XFER_FAILED);
+  if (failed != xfers_failed_reported) {
+    printf("Display: %lu SPI transfers failed\n", failed - xfers_failed_reported);
+    xfers_failed_reported = failed;
+  }
+}
+
 // Initialize the SPIM
 void spi_init(void) {
   // Edit the configuration 
@@ -24,9 +227,11 @@ void spi_init(void) {
     .frequency    = NRF_SPIM_FREQ_8M,  
     .mode         = NRF_SPIM_MODE_0,  
     .bit_order    = NRF_SPIM_BIT_ORDER_MSB_FIRST,
+    .irq_priority = APP_IRQ_PRIORITY_LOW,
   };
 
-  nrfx_err_t err = nrfx_spim_init(&spi, &config, NULL, NULL);
+  // Transfers complete in spim_handler, so nothing waits for the bus
+  nrfx_err_t err = nrfx_spim_init(&spi, &config, spim_handler, NULL);
   if (err == NRFX_SUCCESS) {
     printf("SPI Initialized Successfully!\n");
   } else if (err == NRFX_ERROR_FORBIDDEN) {
@@ -44,89 +249,171 @@ void spi_init(void) {
 void gpio_init(void) {
   // Set pins as output
   nrf_gpio_cfg_output(EDGE_P12);  // D/C Pin
-  nrf_gpio_cfg_output(EDGE_P8);   // RESET Pin
+  nrf_gpio_cfg_output(EDGE_P6);   // RESET Pin (P8 and P9 are the NFC antenna)
   nrf_gpio_cfg_output(EDGE_P16);  // CS Pin
   // Set pins high initially
   nrf_gpio_pin_set(EDGE_P12);
-  nrf_gpio_pin_set(EDGE_P8);  
+  nrf_gpio_pin_set(EDGE_P6);  
   nrf_gpio_pin_set(EDGE_P16);  
 }
 
-// Initialize the display
-void display_init(void) {
+// Panel delays during initialization: RESX low pulse, then the wait before
+// commands and sleep-out are accepted, then the wait after sleep-out
+#define RESET_LOW_MS   10
+#define RESET_WAIT_MS  120
+#define SLEEP_OUT_MS   120
+
+// How often to check whether sleep-out has been sent
+#define SEND_POLL_MS   10
+
+// Non-blocking initialization steps, separated by the panel delays
+typedef enum {
+  INIT_RESET_RELEASE,
+  INIT_CONFIGURE,
+  INIT_SLEEP_OUT_SENT,
+  INIT_DISPLAY_ON,
+  INIT_DONE,
+} init_step_t;
+
+APP_TIMER_DEF(m_display_timer);
+static init_step_t init_step = INIT_DONE;
+static bool ready = false;
+static display_ready_handler_t ready_handler = NULL;
+static uint32_t sleep_out_fence = 0;
+
+static void init_step_handler(void* p_event_data, uint16_t event_size);
+
+// Run the next step from the main loop once its delay has passed
+static void init_timer_handler(void* p_context) {
+  runtime_post(init_step_handler, NULL, 0);
+}
+
+static void schedule_step(init_step_t step, uint32_t delay_ms) {
+  init_step = step;
+  ret_code_t error_code = app_timer_start(m_display_timer, APP_TIMER_TICKS(delay_ms), NULL);
+  APP_ERROR_CHECK(error_code);
+}
+
+// Register configuration (Official Adafruit-style initialization). Kept in
+// flash: every entry fits in a transfer's inline copy, since EasyDMA cannot
+// read flash.
+typedef struct {
+  uint8_t cmd;
+  uint8_t length;
+  uint8_t data[15];
+} panel_register_t;
+
+static const panel_register_t panel_config[] = {
+  {0xEF, 3, {0x03, 0x80, 0x02}},
+  {0xCF, 3, {0x00, 0xC1, 0x30}},
+  {0xED, 4, {0x64, 0x03, 0x12, 0x81}},
+  {0xE8, 3, {0x85, 0x00, 0x78}},
+  {0xCB, 5, {0x39, 0x2C, 0x00, 0x34, 0x02}},
+  {0xF7, 1, {0x20}},
+  {0xEA, 2, {0x00, 0x00}},
+
+  // Power controls
+  {0xC0, 1, {0x23}},
+  {0xC1, 1, {0x10}},
+
+  // VCOM controls
+  {0xC5, 2, {0x3E, 0x28}},
+  {0xC7, 1, {0x86}},
+  {0x36, 1, {0x00}},          // Memory Access Control
+  {0x3A, 1, {0x55}},          // Pixel Format
+  {0xB1, 2, {0x00, 0x18}},
+  {0xB6, 3, {0x08, 0x82, 0x27}},
+  {0xF2, 1, {0x00}},          // Disable Gamma correction
+  {0x26, 1, {0x01}},          // Gamma curves
+  {0xE0, 15, {0x0F, 0x31, 0x2B, 0x0C, 0x0E, 0x08, 0x4E, 0xF1, 0x37, 0x07, 0x10, 0x03, 0x0E, 0x09, 0x00}},
+  {0xE1, 15, {0x00, 0x0E, 0x14, 0x03, 0x11, 0x07, 0x31, 0xC1, 0x48, 0x08, 0x0F, 0x0C, 0x31, 0x36, 0x0F}},
+};
+
+_Static_assert(sizeof(((panel_register_t*)0)->data) <= DISPLAY_XFER_INLINE_MAX,
+               "Panel configuration must be copied into the transfer queue");
+
+// Send the register configuration
+static void configure(void) {
+  for (size_t i = 0; i < sizeof(panel_config) / sizeof(panel_config[0]); i++) {
+    spi_write_command(panel_config[i].cmd);
+    queue_payload(true, panel_config[i].data, panel_config[i].length, 1);
+  }
+}
+
+static void init_step_handler(void* p_event_data, uint16_t event_size) {
+  switch (init_step) {
+    case INIT_RESET_RELEASE:
+      nrf_gpio_pin_set(EDGE_P6);
+      schedule_step(INIT_CONFIGURE, RESET_WAIT_MS);
+      break;
+
+    case INIT_CONFIGURE:
+      // Display RAM can be written while still asleep, so clear it now
+      configure();
+      fill_screen(0x0000);
+      spi_write_command(0x11);  // Exit sleep mode
+      sleep_out_fence = display_fence();
+      schedule_step(INIT_SLEEP_OUT_SENT, SEND_POLL_MS);
+      break;
+
+    case INIT_SLEEP_OUT_SENT:
+      // The sleep-out delay counts from when the clear has gone out
+      if (display_fence_reached(sleep_out_fence)) {
+        schedule_step(INIT_DISPLAY_ON, SLEEP_OUT_MS);
+      } else {
+        schedule_step(INIT_SLEEP_OUT_SENT, SEND_POLL_MS);
+      }
+      break;
+
+    case INIT_DISPLAY_ON:
+      spi_write_command(0x29);  // Turn on the display
+      init_step = INIT_DONE;
+      ready = true;
+      printf("Display Initialized!\n");
+      if (ready_handler != NULL) {
+        ready_handler();
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+// Start initializing the display. Returns at once; the panel delays run on
+// a timer and the remaining steps run from the main loop, so other
+// initialization can proceed meanwhile. The handler is called from the main
+// loop when the display is ready. Needs app_timer and the runtime.
+void display_init(display_ready_handler_t handler) {
+  ready = false;
+  ready_handler = handler;
   gpio_init();
 
+  ret_code_t error_code = app_timer_create(&m_display_timer, APP_TIMER_MODE_SINGLE_SHOT, init_timer_handler);
+  APP_ERROR_CHECK(error_code);
+  error_code = app_timer_create(&m_pause_timer, APP_TIMER_MODE_SINGLE_SHOT, pause_timer_handler);
+  APP_ERROR_CHECK(error_code);
+
   // Reset everything
-  nrf_gpio_pin_clear(EDGE_P8);  
-  nrf_delay_ms(100);
-  nrf_gpio_pin_set(EDGE_P8);   
-  nrf_delay_ms(100);
-
-  // Official Adafruit-style initialization
-  spi_write_command(0xEF);  uint8_t ef[] = {0x03, 0x80, 0x02};  spi_write_data(ef, 3);
-  spi_write_command(0xCF);  uint8_t cf[] = {0x00, 0xC1, 0x30};  spi_write_data(cf, 3);
-  spi_write_command(0xED);  uint8_t ed[] = {0x64, 0x03, 0x12, 0x81}; spi_write_data(ed, 4);
-  spi_write_command(0xE8);  uint8_t e8[] = {0x85, 0x00, 0x78}; spi_write_data(e8, 3);
-  spi_write_command(0xCB);  uint8_t cb[] = {0x39, 0x2C, 0x00, 0x34, 0x02}; spi_write_data(cb, 5);
-  spi_write_command(0xF7);  uint8_t f7[] = {0x20}; spi_write_data(f7, 1);
-  spi_write_command(0xEA);  uint8_t ea[] = {0x00, 0x00}; spi_write_data(ea, 2);
-  
-  // Initialize power controls
-  spi_write_command(0xC0);  uint8_t c0[] = {0x23}; spi_write_data(c0, 1);  
-  spi_write_command(0xC1);  uint8_t c1[] = {0x10}; spi_write_data(c1, 1);  
-
-  // Initialize VCOM controls
-  spi_write_command(0xC5);  uint8_t c5[] = {0x3E, 0x28}; spi_write_data(c5, 2);  
-  spi_write_command(0xC7);  uint8_t c7[] = {0x86}; spi_write_data(c7, 1);  
-  spi_write_command(0x36);  uint8_t madctl[] = {0x00}; spi_write_data(madctl, 1); // Memory Access Control
-  spi_write_command(0x3A);  uint8_t pixfmt[] = {0x55}; spi_write_data(pixfmt, 1); // Pixel Format
-  spi_write_command(0xB1);  uint8_t frmctr1[] = {0x00, 0x18}; spi_write_data(frmctr1, 2);
-  spi_write_command(0xB6);  uint8_t dfunctr[] = {0x08, 0x82, 0x27}; spi_write_data(dfunctr, 3);
-  spi_write_command(0xF2);  uint8_t f2[] = {0x00}; spi_write_data(f2, 1);  // Disable Gamma correction
-  spi_write_command(0x26);  uint8_t gamma[] = {0x01}; spi_write_data(gamma, 1);  // Gamma curves
-  spi_write_command(0xE0);  uint8_t gmctrp1[] = {0x0F, 0x31, 0x2B, 0x0C, 0x0E, 0x08, 0x4E, 0xF1, 0x37, 0x07, 0x10, 0x03, 0x0E, 0x09, 0x00}; spi_write_data(gmctrp1, 15);
-  spi_write_command(0xE1);  uint8_t gmctrn1[] = {0x00, 0x0E, 0x14, 0x03, 0x11, 0x07, 0x31, 0xC1, 0x48, 0x08, 0x0F, 0x0C, 0x31, 0x36, 0x0F}; spi_write_data(gmctrn1, 15);
-
-  // Exit sleep mode and turn on the display
-  spi_write_command(0x11);  
-  nrf_delay_ms(120);
-  spi_write_command(0x29);  
-
-  printf("Display Initialized!\n");
+  nrf_gpio_pin_clear(EDGE_P6);
+  schedule_step(INIT_RESET_RELEASE, RESET_LOW_MS);
 }
 
-// Helper to write commands to the display
-void spi_write_command(uint8_t cmd) {
-  uint8_t tx_data = cmd;
-  
-  nrf_gpio_pin_clear(EDGE_P16);  // Pull the chip select low
-  nrf_gpio_pin_clear(EDGE_P12);  // Set D/C low because we are sending a command
-
-  // Send the TX transfer
-  nrfx_spim_xfer_desc_t xfer = NRFX_SPIM_XFER_TX(&tx_data, 1);
-  nrfx_err_t err = nrfx_spim_xfer(&spi, &xfer, 0);
-  if (err != NRFX_SUCCESS) {
-      printf("SPI Command Failed: %lu\n", err);
-  }
+// Whether display_init() has finished
+bool display_is_ready(void) {
+  return ready;
+}
 
-  // Pull chip select back high
-  nrf_gpio_pin_set(EDGE_P16); 
+// Queue a command for the display (D/C low). The SPIM drives chip select.
+void spi_write_command(uint8_t cmd) {
+  queue_payload(false, &cmd, 1, 1);
 }
 
-// Helper to write data to the display
+// Queue data for the display (D/C high). Data larger than
+// DISPLAY_XFER_INLINE_MAX is sent in place, so it must not change until
+// display_fence_reached() says it has gone out.
 void spi_write_data(uint8_t *data, size_t length) {
-  nrf_gpio_pin_clear(EDGE_P16);  // Pull the chip select low
-  nrf_gpio_pin_set(EDGE_P12);    // Set D/C high because we are sending data
-
-  // Send the TX transfer
-  nrfx_spim_xfer_desc_t xfer = NRFX_SPIM_XFER_TX(data, length);
-  nrfx_err_t err = nrfx_spim_xfer(&spi, &xfer, 0);  
-  if (err != NRFX_SUCCESS) {
-      printf("SPI Data Failed: %lu\n", err);
-  }
-
-  // Pull chip select back high
-  nrf_gpio_pin_set(EDGE_P16); 
+  queue_payload(true, data, length, 1);
 }
 
 // Set the display window for the next writes
@@ -151,46 +438,55 @@ void setAddrWindow(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
 
 // Fill the screen with one color
 void fill_screen(uint16_t color) {
-  // Set the window to the full screen
-  setAddrWindow(0, 0, 239, 319);
-  // Extract the color
-  uint8_t data[2] = {color >> 8, color & 0xFF};
-  // Fill each pixel with the given color
-  for (uint32_t i = 0; i < 240 * 320; i++) {
-      spi_write_data(data, 2);  
+  // One line of pixels, sent once per row by a single queued transfer
+  static uint8_t line[240 * 2];
+  display_flush();
+  for (uint32_t i = 0; i < 240; i++) {
+    line[2 * i] = color >> 8;
+    line[2 * i + 1] = color & 0xFF;
   }
 
-  printf("Done filling screen\n");
+  // Set the window to the full screen and fill it line by line
+  setAddrWindow(0, 0, 239, 319);
+  queue_payload(true, line, sizeof(line), 320);
 }
 
+// Pixels of one glyph: 24 rows of 13 font columns, each 3 pixels wide
+#define GLYPH_BYTES (24 * 13 * 3 * 2)
+
+// Two glyph buffers, so the next glyph is rendered while the last is sent
+static uint8_t glyph_buffers[2][GLYPH_BYTES];
+static uint32_t glyph_fences[2];
+static uint8_t next_glyph = 0;
+
 // Write a character on the display at the given coordinates and colors
 void write_text(char c, uint16_t color, uint16_t background_color, uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
   // Get the ASCII and bit-map index of the char
   int ascii = c;
   int index = ascii - 32;
-  // Set the address window
-  setAddrWindow(x1, y1, x2, y2);
+
+  // Wait for the buffer's previous glyph to go out
+  uint8_t* pixels = glyph_buffers[next_glyph];
+  while (!display_fence_reached(glyph_fences[next_glyph])) {
+    wait_for_bus(xfers_completed);
+  }
+
   // Extract the text and background color
   uint8_t data[2] = {color >> 8, color & 0xFF};
   uint8_t background[2] = {background_color >> 8, background_color & 0xFF};
 
   // Set the mask and loop through the desired pixels
   uint8_t mask = 0x80;
+  uint32_t n = 0;
   for(int i = 0; i < 24; i++){
     for(int j = 0; j < 13; j++){
       // Get the current row
       uint8_t curr = display_font[index][12 - j];
-      if((curr & mask) == mask){  
-        // 3 times since 3x original
-        spi_write_data(data, 2);
-        spi_write_data(data, 2);
-        spi_write_data(data, 2);
-      }
-      else{
-        // 3 times since 3x original
-        spi_write_data(background, 2);
-        spi_write_data(background, 2);
-        spi_write_data(background, 2);
+      uint8_t const* pixel = ((curr & mask) == mask) ? data : background;
+      // 3 times since 3x original
+      for (int k = 0; k < 3; k++) {
+        pixels[n++] = pixel[0];
+        pixels[n++] = pixel[1];
       }
     }
 
@@ -199,6 +495,12 @@ void write_text(char c, uint16_t color, uint16_t background_color, uint16_t x1,
       mask = mask >> 1;
     }
   }
+
+  // Set the address window and send the whole glyph in one transfer
+  setAddrWindow(x1, y1, x2, y2);
+  spi_write_data(pixels, GLYPH_BYTES);
+  glyph_fences[next_glyph] = display_fence();
+  next_glyph ^= 1;
 }
 
 // Write the temperature to the display
@@ -305,8 +607,6 @@ void write_bpm(int bpm) {
   sprintf(buffer, "%d", bpm);  // Convert number to string
   int new_digit_count = strlen(buffer);  // Get the current digit count
 
-  printf("BPM as string: %s\n", buffer); // Debugging
-
   // Display settings
   uint16_t white = 0xFFFF;
   uint16_t black = 0x0000;
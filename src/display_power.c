@@ -0,0 +1,108 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "app_timer.h"
+#include "display.h"
+#include "display_power.h"
+#include "metrics.h"
+
+// ILI9341 commands
+#define CMD_SLEEP_IN        0x10
+#define CMD_SLEEP_OUT       0x11
+#define CMD_DISPLAY_OFF     0x28
+#define CMD_DISPLAY_ON      0x29
+#define CMD_IDLE_MODE_OFF   0x38
+#define CMD_IDLE_MODE_ON    0x39
+
+// Commands must wait this long after sleep-in or sleep-out. The wait is
+// queued as a pause on the transfer queue, so the main loop never blocks.
+#define SLEEP_COMMAND_DELAY_MS 5
+
+static const metric_id_t mode_metrics[DISPLAY_MODE_COUNT] = {
+  [DISPLAY_MODE_ACTIVE] = METRIC_DISPLAY_ACTIVE_MS,
+  [DISPLAY_MODE_IDLE]   = METRIC_DISPLAY_IDLE_MS,
+  [DISPLAY_MODE_SLEEP]  = METRIC_DISPLAY_SLEEP_MS,
+};
+
+static display_mode_t mode = DISPLAY_MODE_ACTIVE;
+
+// Time accounting, folded in on every call so the 24-bit RTC counter never wraps
+static uint32_t last_update = 0;
+static uint64_t mode_ticks[DISPLAY_MODE_COUNT];
+static uint32_t static_ticks = 0;     // Since the text on screen last changed
+static uint32_t inactive_ticks = 0;   // Since the last valid reading
+
+// Add the time since the last call to the counters
+static void account(void) {
+  uint32_t now = app_timer_cnt_get();
+  uint32_t elapsed = app_timer_cnt_diff_compute(now, last_update);
+  last_update = now;
+  mode_ticks[mode] += elapsed;
+  static_ticks += elapsed;
+  inactive_ticks += elapsed;
+}
+
+static void set_mode(display_mode_t new_mode) {
+  account();
+  mode = new_mode;
+}
+
+// Start accounting in full-color mode. Call after display_init().
+void display_power_init(void) {
+  mode = DISPLAY_MODE_ACTIVE;
+  last_update = app_timer_cnt_get();
+  printf("Display power management initialized!\n");
+}
+
+// Bring the display back to full color before a redraw. Does not count as a
+// change: redrawing the same text must not hold off idle mode.
+void display_power_wake(void) {
+  if (mode == DISPLAY_MODE_SLEEP) {
+    // Display RAM and settings survive sleep, so only the panel needs restarting
+    spi_write_command(CMD_SLEEP_OUT);
+    display_pause(SLEEP_COMMAND_DELAY_MS);
+    spi_write_command(CMD_IDLE_MODE_OFF);
+    spi_write_command(CMD_DISPLAY_ON);
+    set_mode(DISPLAY_MODE_ACTIVE);
+  } else if (mode == DISPLAY_MODE_IDLE) {
+    spi_write_command(CMD_IDLE_MODE_OFF);
+    set_mode(DISPLAY_MODE_ACTIVE);
+  }
+}
+
+// Wake the display for text that differs from what is on screen, and restart
+// the idle timeout
+void display_power_changed(void) {
+  display_power_wake();
+  static_ticks = 0;
+}
+
+// Note a valid reading, which keeps the display awake
+void display_power_activity(void) {
+  inactive_ticks = 0;
+}
+
+// Move to idle or sleep mode when the timeouts expire and publish the time
+// spent in each mode. Call at least every few minutes.
+void display_power_update(void) {
+  account();
+  if (mode != DISPLAY_MODE_SLEEP && inactive_ticks >= APP_TIMER_TICKS(DISPLAY_SLEEP_AFTER_MS)) {
+    spi_write_command(CMD_DISPLAY_OFF);
+    spi_write_command(CMD_SLEEP_IN);
+    display_pause(SLEEP_COMMAND_DELAY_MS);
+    mode = DISPLAY_MODE_SLEEP;
+  } else if (mode == DISPLAY_MODE_ACTIVE && static_ticks >= APP_TIMER_TICKS(DISPLAY_IDLE_AFTER_MS)) {
+    spi_write_command(CMD_IDLE_MODE_ON);
+    mode = DISPLAY_MODE_IDLE;
+  }
+
+  for (int m = 0; m < DISPLAY_MODE_COUNT; m++) {
+    metrics_set(mode_metrics[m], (uint32_t)((mode_ticks[m] * 1000) / APP_TIMER_TICKS(1000)));
+  }
+}
+
+// Current power mode
+display_mode_t display_power_mode(void) {
+  return mode;
+}
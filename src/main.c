@@ -11,7 +11,16 @@
 #include "pulsesensor.h"
 #include "pulsesensor_util.h"
 #include "display.h"
+#include "display_power.h"
+#include "runtime.h"
+#include "tasks.h"
+#include "session_log.h"
+#include "telemetry.h"
+#include "nfc_tag.h"
+#include "boot.h"
+#include "memory_stats.h"
 #include "nrfx_spim.h"
+#include "nrfx_gpiote.h"
 
 #include <stdio.h>
 #include <math.h>
@@ -20,21 +29,73 @@
 // Global I2C manager instance
 NRF_TWI_MNGR_DEF(twi_mngr_instance, 1, 0);
 
+// Runs from the main loop once the display is initialized and cleared
+static void display_ready(void) {
+  // Write initializing to the screen
+  write_initializing();
+
+  // Start the display power accounting
+  display_power_init();
+  boot_mark(BOOT_PHASE_DISPLAY);
+}
+
+// Runs from the main loop: start streaming a session over telemetry
+static void export_session(void* p_event_data, uint16_t event_size) {
+  uint16_t session = *(uint16_t const*)p_event_data;
+  ret_code_t err_code = session_log_export(session);
+  if (err_code != NRF_SUCCESS) {
+    printf("Cannot export session %u (error 0x%lX)\n", session, err_code);
+  }
+}
+
+// Button A exports the current session (records already in flash), button B
+// the previous one
+static void button_handler(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action) {
+  uint16_t session = session_log_current();
+  // Session IDs start at 1, and without the log there is nothing to export
+  if (!session_log_available() || (pin == BTN_B && session <= 1)) {
+    return;
+  }
+  if (pin == BTN_B) {
+    session--;
+  }
+  runtime_post(export_session, &session, sizeof(session));
+}
+
+// Watch the buttons (the board has external pull-ups)
+static void buttons_init(void) {
+  if (!nrfx_gpiote_is_init()) {
+    ret_code_t err_code = nrfx_gpiote_init();
+    APP_ERROR_CHECK(err_code);
+  }
+  nrfx_gpiote_in_config_t config = NRFX_GPIOTE_CONFIG_IN_SENSE_HITOLO(false);
+  ret_code_t err_code = nrfx_gpiote_in_init(BTN_A, &config, button_handler);
+  APP_ERROR_CHECK(err_code);
+  err_code = nrfx_gpiote_in_init(BTN_B, &config, button_handler);
+  APP_ERROR_CHECK(err_code);
+  nrfx_gpiote_in_event_enable(BTN_A, true);
+  nrfx_gpiote_in_event_enable(BTN_B, true);
+}
+
 int main(void) {
+  // Paint the stack for the high-water mark, then start timing the boot
+  memory_stats_init();
+  boot_init();
   printf("Board started!\n");
 
-  // Initialize the SPI
-  spi_init();
-  display_init();
+  // Initalize Timer Module 
+  ret_code_t err_code = app_timer_init();
+  APP_ERROR_CHECK(err_code);
+  printf("Timer initialized!\n");
 
-  // Different Colors
-  uint16_t white = 0xFFFF;
-  uint16_t black = 0x0000;
+  // Initialize the event queue and power management
+  runtime_init();
+  boot_mark(BOOT_PHASE_CLOCKS);
 
-  // Fill the screen black
-  fill_screen(black);
-  // Write initializing to the screen
-  write_initializing();
+  // Initialize the SPI and start the display. Its reset and sleep-out delays
+  // run in the background while the rest of the board is initialized.
+  spi_init();
+  display_init(display_ready);
 
   // Initialize I2C and configure peripheral and driver
   nrf_drv_twi_config_t i2c_config = NRF_DRV_TWI_DEFAULT_CONFIG;
@@ -48,21 +109,31 @@ int main(void) {
   // Initialize the MAX30102 sensor
   max30102_init(&twi_mngr_instance);
   printf("Temp Sensor initialized!\n");
-  
-  // Initialize the ADC
-  adc_init();
-  printf("Pulse Sensor initialized!\n");
+  boot_mark(BOOT_PHASE_SENSORS);
 
-  // Initalize Timer Module 
-  ret_code_t err_code = app_timer_init();
-  APP_ERROR_CHECK(err_code);
-  printf("Timer initialized!\n");
+  // Open flash storage and start a new session
+  session_log_init();
 
-  // Start pulse sensor sampling (2 ms interval)
-  start_sample_timer();
+  // Start the binary telemetry stream; the buttons export sessions over it
+  telemetry_init();
+  buttons_init();
 
-  while (1) {
-  }
+  // Start publishing readings to NFC readers
+  nfc_tag_init();
+  boot_mark(BOOT_PHASE_STORAGE);
+
+  // Initialize the pulse pipelines and the ADC
+  pulse_processing_init();
+  printf("Pulse Sensor initialized!\n");
+
+  // Start the periodic tasks (pulse sensor sampling every 2 ms). The pipeline
+  // warms up while the display finishes initializing.
+  tasks_init();
+  tasks_start();
+  boot_mark(BOOT_PHASE_TASKS);
+
+  // Handle events and sleep in between
+  runtime_run();
   
   return 0;
-}
\ No newline at end of file
+}
@@ -1,15 +1,20 @@
 // MAX30102 driver for Microbit_v2
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <math.h>
 
 #include "max30102.h"
-#include "display.h"
-#include "nrf_delay.h"
 
 // Pointer to an initialized I2C instance to use for transactions
 static const nrf_twi_mngr_t* i2c_manager = NULL;
 
+// Last temperature reading
+static int8_t last_temp_int = 0;
+static uint8_t last_temp_frac = 0;
+static bool last_temp_valid = false;
+static bool temp_conversion_started = false;
+
 // Helper function to perform an arbitrary length I2C read of a given register
 //
 // i2c_addr - address of the device to read from
@@ -121,24 +126,42 @@ max30102_measurement_t max30102_read_sample(void) {
   return sample;
 }
 
-// Read the temperature
-float max30102_read_temp(void) {
-  // Temperature configuration
+// Start a temperature conversion (takes about 29 ms)
+void max30102_start_temp(void) {
   i2c_reg_write(MAX30102_ADDRESS, TEMP_CONFIG, 0x01);
-  nrf_delay_ms(50);
+}
 
+// Read the result of the last temperature conversion
+float max30102_read_temp(void) {
   // Read the digit part of the temperature
   int8_t temp_int;
-  i2c_reg_read(MAX30102_ADDRESS, TEMP_INT, 1, &temp_int);
+  i2c_reg_read(MAX30102_ADDRESS, TEMP_INT, 1, (uint8_t*)&temp_int);
   // Read the fractional part of the temperature
   uint8_t temp_frac;
   i2c_reg_read(MAX30102_ADDRESS, TEMP_FRAC, 1, &temp_frac);
   // Calculate the overall temperature
   float temp = (float)temp_int + (float)temp_frac * 0.0625;
-  // Write it to the display
-  write_temp(temp_int, temp_frac);
+  last_temp_int = temp_int;
+  last_temp_frac = temp_frac;
+  last_temp_valid = true;
 
   printf("Current Temperature: %.2f °C\n", temp);
   return temp;
 }
 
+// Get the last temperature reading. Returns false until one is available.
+bool max30102_get_last_temp(int8_t* temp_int, uint8_t* temp_frac) {
+  *temp_int = last_temp_int;
+  *temp_frac = last_temp_frac;
+  return last_temp_valid;
+}
+
+// Temperature task: read the conversion started on the previous run, then
+// start the next one, so no run ever waits for the sensor
+void temperature_task(void) {
+  if (temp_conversion_started) {
+    max30102_read_temp();
+  }
+  max30102_start_temp();
+  temp_conversion_started = true;
+}
@@ -0,0 +1,66 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#include "nrf.h"
+#include "memory_stats.h"
+#include "metrics.h"
+
+// Pattern the unused stack is painted with
+#define STACK_PAINT 0xA5A5A5A5UL
+
+// Bytes left unpainted below the stack pointer in memory_stats_init()
+#define STACK_PAINT_MARGIN 64
+
+// RAM layout, from the SDK linker script and startup file
+extern uint32_t __data_start__;
+extern uint32_t __data_end__;
+extern uint32_t __bss_start__;
+extern uint32_t __bss_end__;
+extern uint32_t __HeapBase;
+extern uint32_t __HeapLimit;
+extern uint32_t __StackLimit;
+extern uint32_t __StackTop;
+
+// Lowest stack word found overwritten so far
+static uint32_t const* deepest = &__StackTop;
+
+// Paint the free stack below the current frame. Call first thing in main(),
+// while the stack is shallow.
+void memory_stats_init(void) {
+  volatile uint32_t* word = &__StackLimit;
+  uint32_t* end = (uint32_t*)(uintptr_t)(__get_MSP() - STACK_PAINT_MARGIN);
+  while (word < end) {
+    *word++ = STACK_PAINT;
+  }
+}
+
+// Measure the RAM layout and scan for the stack high-water mark
+memory_stats_t memory_stats_get(void) {
+  // Words below the mark that still hold the pattern were never touched
+  volatile uint32_t const* word = &__StackLimit;
+  while (word < deepest && *word == STACK_PAINT) {
+    word++;
+  }
+  deepest = (uint32_t const*)word;
+
+  memory_stats_t stats = {
+    .static_bytes = (uintptr_t)&__data_end__ - (uintptr_t)&__data_start__ +
+                    (uintptr_t)&__bss_end__ - (uintptr_t)&__bss_start__,
+    .heap_bytes = (uintptr_t)&__HeapLimit - (uintptr_t)&__HeapBase,
+    .unused_bytes = (uintptr_t)&__StackLimit - (uintptr_t)&__HeapLimit,
+    .stack_bytes = (uintptr_t)&__StackTop - (uintptr_t)&__StackLimit,
+    .high_water_bytes = (uintptr_t)&__StackTop - (uintptr_t)deepest,
+  };
+  return stats;
+}
+
+// Publish the RAM budget and stack high-water mark as metrics
+void memory_stats_update(void) {
+  memory_stats_t stats = memory_stats_get();
+  metrics_set(METRIC_RAM_STATIC_BYTES, stats.static_bytes);
+  metrics_set(METRIC_RAM_HEAP_BYTES, stats.heap_bytes);
+  metrics_set(METRIC_RAM_UNUSED_BYTES, stats.unused_bytes);
+  metrics_set(METRIC_STACK_SIZE_BYTES, stats.stack_bytes);
+  metrics_set(METRIC_STACK_HIGH_WATER_BYTES, stats.high_water_bytes);
+  metrics_set(METRIC_STACK_HEADROOM_BYTES, stats.stack_bytes - stats.high_water_bytes);
+}
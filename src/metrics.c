@@ -0,0 +1,67 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#include "nrf_atomic.h"
+#include "metrics.h"
+
+// Current value of every metric
+static nrf_atomic_u32_t metric_values[METRIC_COUNT];
+
+// Printable metric names, in the same order as metric_id_t
+static const char* const metric_names[METRIC_COUNT] = {
+  [METRIC_CPU_LOAD_PERMILLE]        = "cpu_load_permille",
+  [METRIC_WAKEUPS_PER_SEC]          = "wakeups_per_sec",
+  [METRIC_EVENTS_DROPPED]           = "events_dropped",
+  [METRIC_TASK_OVERRUNS]            = "task_overruns",
+  [METRIC_LOG_RECORDS_WRITTEN]      = "log_records_written",
+  [METRIC_LOG_READINGS_DROPPED]     = "log_readings_dropped",
+  [METRIC_LOG_SCANS_PAUSED]         = "log_scans_paused",
+  [METRIC_LOG_FULL]                 = "log_full",
+  [METRIC_TELEMETRY_BYTES_SENT]     = "telemetry_bytes_sent",
+  [METRIC_TELEMETRY_PACKETS_DROPPED]= "telemetry_packets_dropped",
+  [METRIC_SQI_SCORE]                = "sqi_score",
+  [METRIC_SQI_LOW_WINDOWS]          = "sqi_low_windows",
+  [METRIC_SQI_BPM_SKIPPED]          = "sqi_bpm_skipped",
+  [METRIC_SQI_REDRAWS_SKIPPED]      = "sqi_redraws_skipped",
+  [METRIC_SQI_LOG_SKIPPED]          = "sqi_log_skipped",
+  [METRIC_DISPLAY_ACTIVE_MS]        = "display_active_ms",
+  [METRIC_DISPLAY_IDLE_MS]          = "display_idle_ms",
+  [METRIC_DISPLAY_SLEEP_MS]         = "display_sleep_ms",
+  [METRIC_BOOT_PROVISIONAL_MS]      = "boot_provisional_ms",
+  [METRIC_BOOT_FIRST_BPM_MS]        = "boot_first_bpm_ms",
+  [METRIC_NFC_FIELD_ON]             = "nfc_field_on",
+  [METRIC_NFC_NDEF_READS]           = "nfc_ndef_reads",
+  [METRIC_NFC_BYTES_PATCHED]        = "nfc_bytes_patched",
+  [METRIC_DISPLAY_BUS_PERMILLE]     = "display_bus_permille",
+  [METRIC_DISPLAY_OVERLAP_PERMILLE] = "display_overlap_permille",
+  [METRIC_RAM_STATIC_BYTES]         = "ram_static_bytes",
+  [METRIC_RAM_HEAP_BYTES]           = "ram_heap_bytes",
+  [METRIC_RAM_UNUSED_BYTES]         = "ram_unused_bytes",
+  [METRIC_STACK_SIZE_BYTES]         = "stack_size_bytes",
+  [METRIC_STACK_HIGH_WATER_BYTES]   = "stack_high_water_bytes",
+  [METRIC_STACK_HEADROOM_BYTES]     = "stack_headroom_bytes",
+  [METRIC_LOG_DELETE_FAILURES]      = "log_delete_failures",
+  [METRIC_DISPLAY_XFER_FAILED]      = "display_xfer_failed",
+};
+
+// Overwrite a metric (safe to call from interrupts)
+void metrics_set(metric_id_t id, uint32_t value) {
+  nrf_atomic_u32_store(&metric_values[id], value);
+}
+
+// Increment a counter metric (safe to call from interrupts)
+void metrics_add(metric_id_t id, uint32_t delta) {
+  nrf_atomic_u32_add(&metric_values[id], delta);
+}
+
+// Read the current value of a metric
+uint32_t metrics_get(metric_id_t id) {
+  return metric_values[id];
+}
+
+// Print every metric as a "name=value" line
+void metrics_report(void) {
+  for (int i = 0; i < METRIC_COUNT; i++) {
+    printf("%s=%lu\n", metric_names[i], metrics_get(i));
+  }
+}
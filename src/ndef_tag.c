@@ -0,0 +1,134 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ndef_tag.h"
+
+// NDEF record header flags
+#define NDEF_MB 0x80                // Message begin
+#define NDEF_ME 0x40                // Message end
+#define NDEF_SR 0x10                // Short record (1-byte payload length)
+#define NDEF_TNF_WELL_KNOWN 0x01
+
+// Text status byte: UTF-8 with a 2-byte language code
+#define TEXT_STATUS 0x02
+
+// Record texts as laid out before any reading, and where their values start
+static const char bpm_text[] = "Heart rate: --- bpm";
+static const char temp_text[] = "Temperature:  --.- C";
+static const char trend_text[] = "Last 5 min: min --- mean --- max --- bpm";
+#define BPM_AT 12
+#define BPM_WIDTH 3
+#define TEMP_AT 13
+#define TEMP_WIDTH 5
+#define TREND_AT 12
+#define TREND_WIDTH 24
+
+_Static_assert(2 + 3 * 7 + sizeof(bpm_text) + sizeof(temp_text) + sizeof(trend_text) - 3 <= NDEF_TAG_FILE_SIZE,
+               "NDEF message must fit in the tag file");
+
+// Append a short English Text record and return the file offset of its text
+static uint16_t append_text_record(ndef_tag_t* tag, uint8_t flags, char const* text, uint8_t length) {
+  uint8_t* record = &tag->file[tag->size];
+  record[0] = flags | NDEF_SR | NDEF_TNF_WELL_KNOWN;
+  record[1] = 1;                // Type length
+  record[2] = 3 + length;       // Payload: status, language, text
+  record[3] = 'T';
+  record[4] = TEXT_STATUS;
+  record[5] = 'e';
+  record[6] = 'n';
+  memcpy(&record[7], text, length);
+  tag->size += 7 + length;
+  return tag->size - length;
+}
+
+// Right-align value in width characters, with decimals digits after the
+// point. Values that do not fit are shown as '*'.
+static void format_fixed(char* out, uint8_t width, int32_t value, uint8_t decimals) {
+  char reversed[12];
+  uint8_t count = 0;
+  uint32_t magnitude = (value < 0) ? -(uint32_t)value : (uint32_t)value;
+  do {
+    if (decimals != 0 && count == decimals) {
+      reversed[count++] = '.';
+    }
+    reversed[count++] = '0' + magnitude % 10;
+    magnitude /= 10;
+  } while (magnitude != 0 || count <= decimals);
+  if (value < 0) {
+    reversed[count++] = '-';
+  }
+
+  if (count > width) {
+    memset(out, '*', width);
+    return;
+  }
+  memset(out, ' ', width - count);
+  for (uint8_t i = 0; i < count; i++) {
+    out[width - 1 - i] = reversed[i];
+  }
+}
+
+// Write width characters of text at offset, touching only the bytes that
+// differ. Returns how many changed.
+static uint8_t patch(ndef_tag_t* tag, uint16_t offset, char const* text, uint8_t width) {
+  uint8_t changed = 0;
+  for (uint8_t i = 0; i < width; i++) {
+    if (tag->file[offset + i] != (uint8_t)text[i]) {
+      tag->file[offset + i] = (uint8_t)text[i];
+      changed++;
+    }
+  }
+  tag->bytes_patched += changed;
+  return changed;
+}
+
+// Lay out the NDEF file with every value shown as dashes
+void ndef_tag_init(ndef_tag_t* tag) {
+  memset(tag, 0, sizeof(*tag));
+  tag->size = 2;
+  tag->bpm_field = append_text_record(tag, NDEF_MB, bpm_text, sizeof(bpm_text) - 1) + BPM_AT;
+  tag->temp_field = append_text_record(tag, 0, temp_text, sizeof(temp_text) - 1) + TEMP_AT;
+  tag->trend_field = append_text_record(tag, NDEF_ME, trend_text, sizeof(trend_text) - 1) + TREND_AT;
+
+  uint16_t length = tag->size - 2;
+  tag->file[0] = length >> 8;
+  tag->file[1] = length & 0xFF;
+}
+
+// Show the current BPM, or dashes for 0. Returns the bytes changed.
+uint8_t ndef_tag_set_bpm(ndef_tag_t* tag, uint32_t bpm) {
+  char text[BPM_WIDTH];
+  if (bpm == 0) {
+    memcpy(text, &bpm_text[BPM_AT], BPM_WIDTH);
+  } else {
+    format_fixed(text, BPM_WIDTH, (int32_t)bpm, 0);
+  }
+  return patch(tag, tag->bpm_field, text, BPM_WIDTH);
+}
+
+// Show a temperature in hundredths of a degree C to one decimal, or dashes
+// for NDEF_TAG_NO_TEMP. Returns the bytes changed.
+uint8_t ndef_tag_set_temp(ndef_tag_t* tag, int16_t temp_centi) {
+  char text[TEMP_WIDTH];
+  if (temp_centi == NDEF_TAG_NO_TEMP) {
+    memcpy(text, &temp_text[TEMP_AT], TEMP_WIDTH);
+  } else {
+    int32_t tenths = (temp_centi >= 0) ? (temp_centi + 5) / 10 : (temp_centi - 5) / 10;
+    format_fixed(text, TEMP_WIDTH, tenths, 1);
+  }
+  return patch(tag, tag->temp_field, text, TEMP_WIDTH);
+}
+
+// Show BPM statistics over the last 5 minutes, or dashes if there were no
+// readings. Returns the bytes changed.
+uint8_t ndef_tag_set_trend(ndef_tag_t* tag, trend_stat_t const* bpm) {
+  char text[TREND_WIDTH];
+  memcpy(text, &trend_text[TREND_AT], TREND_WIDTH);
+  if (bpm->count != 0) {
+    format_fixed(&text[4], 3, bpm->min, 0);
+    format_fixed(&text[13], 3, bpm->mean, 0);
+    format_fixed(&text[21], 3, bpm->max, 0);
+  }
+  return patch(tag, tag->trend_field, text, TREND_WIDTH);
+}
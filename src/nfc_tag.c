@@ -0,0 +1,63 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "nfc_t4t_lib.h"
+#include "nrf.h"
+#include "app_error.h"
+#include "nfc_tag.h"
+#include "ndef_tag.h"
+#include "metrics.h"
+#include "session_log.h"
+
+// Readings use the session log's "no temperature" value
+#if NDEF_TAG_NO_TEMP != SESSION_LOG_NO_TEMP
+#error "NFC tag and session log must agree on the missing temperature value"
+#endif
+
+// NDEF file served to readers
+static ndef_tag_t tag;
+
+// Runs in the NFCT interrupt
+static void nfc_callback(void* context, nfc_t4t_event_t event, const uint8_t* data,
+                         size_t data_length, uint32_t flags) {
+  switch (event) {
+    case NFC_T4T_EVENT_FIELD_ON:
+      metrics_add(METRIC_NFC_FIELD_ON, 1);
+      break;
+    case NFC_T4T_EVENT_NDEF_READ:
+      metrics_add(METRIC_NFC_NDEF_READS, 1);
+      break;
+    default:
+      break;
+  }
+}
+
+// Lay out the NDEF message and start emulating the tag
+void nfc_tag_init(void) {
+  ndef_tag_init(&tag);
+
+  ret_code_t err_code = nfc_t4t_setup(nfc_callback, NULL);
+  APP_ERROR_CHECK(err_code);
+
+  // Read-only NDEF file, served in place without copying
+  err_code = nfc_t4t_ndef_staticpayload_set(tag.file, sizeof(tag.file));
+  APP_ERROR_CHECK(err_code);
+
+  err_code = nfc_t4t_emulation_start();
+  APP_ERROR_CHECK(err_code);
+  printf("NFC tag initialized!\n");
+}
+
+// Patch new readings into the NDEF file. Only the NFCT interrupt is held off
+// while the bytes change, so a read never sees half a value and sampling is
+// never delayed.
+void nfc_tag_update(uint32_t bpm, int16_t temp_centi, trend_stat_t const* bpm_trend) {
+  NVIC_DisableIRQ(NFCT_IRQn);
+  uint32_t patched = ndef_tag_set_bpm(&tag, bpm);
+  patched += ndef_tag_set_temp(&tag, temp_centi);
+  patched += ndef_tag_set_trend(&tag, bpm_trend);
+  NVIC_EnableIRQ(NFCT_IRQn);
+
+  metrics_add(METRIC_NFC_BYTES_PATCHED, patched);
+}
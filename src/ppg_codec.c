@@ -0,0 +1,193 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ppg_codec.h"
+
+// Quotients at or above this are escaped and sent verbatim
+#define RICE_ESCAPE 24
+
+// Largest Rice parameter that fits in the frame header
+#define RICE_MAX_K 31
+
+// Bit writer, MSB first
+typedef struct {
+  uint8_t* out;
+  size_t size;
+  size_t pos;
+  uint32_t acc;
+  uint8_t bits;
+  bool overflow;
+} bit_writer_t;
+
+static void put_bits(bit_writer_t* w, uint32_t value, uint8_t count) {
+  while (count > 0) {
+    uint8_t take = (count > 24) ? 24 : count;
+    count -= take;
+    w->acc = (w->acc << take) | ((value >> count) & ((1UL << take) - 1));
+    w->bits += take;
+    while (w->bits >= 8) {
+      w->bits -= 8;
+      if (w->pos < w->size) {
+        w->out[w->pos++] = (uint8_t)(w->acc >> w->bits);
+      } else {
+        w->overflow = true;
+      }
+    }
+  }
+}
+
+static size_t finish_bits(bit_writer_t* w) {
+  if (w->bits > 0) {
+    put_bits(w, 0, 8 - w->bits);
+  }
+  return w->overflow ? 0 : w->pos;
+}
+
+// Bit reader, MSB first. Reading past the end yields zeros.
+typedef struct {
+  uint8_t const* in;
+  size_t size;
+  size_t pos;
+  uint32_t acc;
+  uint8_t bits;
+} bit_reader_t;
+
+static uint32_t get_bits(bit_reader_t* r, uint8_t count) {
+  uint32_t value = 0;
+  while (count > 0) {
+    if (r->bits == 0) {
+      r->acc = (r->pos < r->size) ? r->in[r->pos] : 0;
+      r->pos++;
+      r->bits = 8;
+    }
+    uint8_t take = (count < r->bits) ? count : r->bits;
+    r->bits -= take;
+    count -= take;
+    value = (value << take) | ((r->acc >> r->bits) & ((1U << take) - 1));
+  }
+  return value;
+}
+
+static uint32_t zigzag_encode(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t zigzag_decode(uint32_t value) {
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// Prediction from the previous samples for a fixed predictor order
+static int32_t predict(int32_t const* x, uint16_t i, uint8_t order) {
+  switch (order) {
+    case 1:  return x[i - 1];
+    case 2:  return 2 * x[i - 1] - x[i - 2];
+    default: return 0;
+  }
+}
+
+// Rice parameter that roughly minimizes the coded size for a mean residual
+static uint8_t rice_parameter(uint32_t sum, uint16_t count) {
+  uint8_t k = 0;
+  while (k < RICE_MAX_K && ((uint64_t)count << (k + 1)) <= sum) {
+    k++;
+  }
+  return k;
+}
+
+// Encode one frame of up to PPG_CODEC_FRAME_SAMPLES samples.
+// Returns the number of bytes written, or 0 if out_size was too small.
+size_t ppg_encode_frame(int32_t const* samples, uint16_t count, uint8_t sample_bits,
+                        uint8_t* out, size_t out_size) {
+  if (count == 0 || count > PPG_CODEC_FRAME_SAMPLES) {
+    return 0;
+  }
+
+  // Pick the predictor order with the smallest residual magnitude
+  uint8_t best_order = 0;
+  uint32_t best_sum = UINT32_MAX;
+  for (uint8_t order = 0; order <= 2 && order < count; order++) {
+    uint32_t sum = 0;
+    for (uint16_t i = order; i < count; i++) {
+      sum += zigzag_encode(samples[i] - predict(samples, i, order));
+    }
+    if (sum < best_sum) {
+      best_sum = sum;
+      best_order = order;
+    }
+  }
+  uint8_t k = rice_parameter(best_sum, count - best_order);
+
+  bit_writer_t w = {out, out_size, 0, 0, 0, false};
+  put_bits(&w, count - 1, 6);
+  put_bits(&w, best_order, 2);
+  put_bits(&w, k, 5);
+
+  for (uint16_t i = 0; i < best_order; i++) {
+    put_bits(&w, zigzag_encode(samples[i]), sample_bits + 1);
+  }
+  for (uint16_t i = best_order; i < count; i++) {
+    uint32_t residual = zigzag_encode(samples[i] - predict(samples, i, best_order));
+    uint32_t quotient = residual >> k;
+    if (quotient < RICE_ESCAPE) {
+      put_bits(&w, (1UL << (quotient + 1)) - 2, quotient + 1);  // quotient ones, then a zero
+      put_bits(&w, residual, k);
+    } else {
+      put_bits(&w, (1UL << RICE_ESCAPE) - 1, RICE_ESCAPE);
+      put_bits(&w, residual, sample_bits + 3);
+    }
+  }
+  return finish_bits(&w);
+}
+
+// Decode one frame. Returns the number of bytes consumed, or 0 if malformed.
+size_t ppg_decode_frame(uint8_t const* in, size_t in_size, uint8_t sample_bits,
+                        int32_t* samples, uint16_t* count) {
+  bit_reader_t r = {in, in_size, 0, 0, 0};
+  uint16_t n = get_bits(&r, 6) + 1;
+  uint8_t order = get_bits(&r, 2);
+  uint8_t k = get_bits(&r, 5);
+  if (order > 2 || order > n) {
+    return 0;
+  }
+
+  for (uint16_t i = 0; i < order; i++) {
+    samples[i] = zigzag_decode(get_bits(&r, sample_bits + 1));
+  }
+  for (uint16_t i = order; i < n; i++) {
+    uint32_t quotient = 0;
+    while (quotient < RICE_ESCAPE && get_bits(&r, 1)) {
+      quotient++;
+    }
+    uint32_t residual = (quotient < RICE_ESCAPE)
+        ? ((quotient << k) | get_bits(&r, k))
+        : get_bits(&r, sample_bits + 3);
+    samples[i] = predict(samples, i, order) + zigzag_decode(residual);
+  }
+
+  *count = n;
+  return (r.pos <= in_size) ? r.pos : 0;
+}
+
+// Start a new stream of samples of the given width
+void ppg_encoder_init(ppg_encoder_t* enc, uint8_t sample_bits) {
+  enc->count = 0;
+  enc->sample_bits = sample_bits;
+}
+
+// Add a sample. Returns the size of the encoded frame once one is complete,
+// otherwise 0.
+size_t ppg_encoder_push(ppg_encoder_t* enc, int32_t sample, uint8_t* out, size_t out_size) {
+  enc->frame[enc->count++] = sample;
+  if (enc->count < PPG_CODEC_FRAME_SAMPLES) {
+    return 0;
+  }
+  return ppg_encoder_flush(enc, out, out_size);
+}
+
+// Encode any buffered samples as a (possibly short) frame
+size_t ppg_encoder_flush(ppg_encoder_t* enc, uint8_t* out, size_t out_size) {
+  size_t length = ppg_encode_frame(enc->frame, enc->count, enc->sample_bits, out, out_size);
+  enc->count = 0;
+  return length;
+}
@@ -0,0 +1,246 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "pulse_pipeline.h"
+
+// Median of a few values (sorted in place)
+static float median(float* values, uint8_t count) {
+  for (uint8_t i = 1; i < count; i++) {
+    float value = values[i];
+    uint8_t j = i;
+    while (j > 0 && values[j - 1] > value) {
+      values[j] = values[j - 1];
+      j--;
+    }
+    values[j] = value;
+  }
+  return (count % 2) ? values[count / 2] : 0.5f * (values[count / 2 - 1] + values[count / 2]);
+}
+
+// Re-estimate the BPM and its confidence band from the accepted RR intervals
+static void update_estimate(pulse_pipeline_t* pipeline) {
+  pulse_estimate_t* estimate = &pipeline->estimate;
+  uint8_t count = pipeline->rr_count;
+  estimate->beat_time_us = pipeline->beat_time_us;
+  estimate->intervals = count;
+  if (count == 0) {
+    estimate->bpm = estimate->bpm_low = estimate->bpm_high = 0.0f;
+    estimate->confidence = 0;
+    return;
+  }
+
+  float values[PULSE_RR_WINDOW];
+  for (uint8_t i = 0; i < count; i++) {
+    values[i] = pipeline->rr_history[i];
+  }
+  float rr = median(values, count);
+
+  // Spread from the median absolute deviation (1.4826 scales it to a
+  // standard deviation), then about 95% bounds on the median itself
+  for (uint8_t i = 0; i < count; i++) {
+    values[i] = fabsf(pipeline->rr_history[i] - rr);
+  }
+  float sigma = 1.4826f * median(values, count);
+  float margin = 2.0f * 1.253f * sigma / sqrtf(count);
+
+  estimate->bpm = 60e6f / rr;
+  estimate->bpm_low = 60e6f / (rr + margin);
+  estimate->bpm_high = (rr > margin) ? 60e6f / (rr - margin) : 240.0f;
+
+  // Confidence falls as the band widens, and is capped until the median has
+  // a full window of intervals
+  float half_width = 0.5f * (estimate->bpm_high - estimate->bpm_low) / estimate->bpm;
+  float confidence = 100.0f * (1.0f - half_width / PULSE_BAND_ZERO_CONFIDENCE);
+  float cap = 100.0f * count / PULSE_RR_WINDOW;
+  if (confidence > cap) {
+    confidence = cap;
+  }
+  estimate->confidence = (confidence > 0.0f) ? (uint8_t)(confidence + 0.5f) : 0;
+}
+
+// Accept or reject a new RR interval
+static void add_interval(pulse_pipeline_t* pipeline, uint32_t rr_us) {
+  if (rr_us < PULSE_RR_MIN_US || rr_us > PULSE_RR_MAX_US) {
+    return;
+  }
+
+  // Compare with the median of the accepted intervals
+  if (pipeline->rr_count == PULSE_RR_WINDOW) {
+    float values[PULSE_RR_WINDOW];
+    for (uint8_t i = 0; i < PULSE_RR_WINDOW; i++) {
+      values[i] = pipeline->rr_history[i];
+    }
+    float rr = median(values, PULSE_RR_WINDOW);
+    if (fabsf(rr_us - rr) * 100.0f > PULSE_RR_OUTLIER_PERCENT * rr) {
+      pipeline->rr_rejected++;
+      if (pipeline->rr_rejected < PULSE_RR_MAX_REJECTED) {
+        return;
+      }
+      // Consistently different: the rate has changed, start over from here
+      pipeline->rr_count = 0;
+    }
+  }
+  pipeline->rr_rejected = 0;
+
+  if (pipeline->rr_count == PULSE_RR_WINDOW) {
+    memmove(&pipeline->rr_history[0], &pipeline->rr_history[1],
+            (PULSE_RR_WINDOW - 1) * sizeof(pipeline->rr_history[0]));
+    pipeline->rr_count--;
+  }
+  pipeline->rr_history[pipeline->rr_count++] = rr_us;
+}
+
+// Time of the maximum of the parabola through three evenly spaced samples,
+// where y1 is the largest and t1 its time
+static uint32_t interpolate_peak(float y0, float y1, float y2, uint32_t t1, uint32_t spacing_us) {
+  float curvature = y0 - 2.0f * y1 + y2;
+  if (curvature >= 0.0f) {
+    return t1;
+  }
+  float offset = 0.5f * (y0 - y2) / curvature;
+  if (offset > 0.5f) {
+    offset = 0.5f;
+  } else if (offset < -0.5f) {
+    offset = -0.5f;
+  }
+  return t1 + (int32_t)(offset * spacing_us);
+}
+
+// Keep the last PULSE_PEAK_FIT_SAMPLES filtered samples
+static void remember_sample(pulse_pipeline_t* pipeline, float filtered, uint32_t time_us) {
+  pipeline->recent[pipeline->recent_index] = filtered;
+  pipeline->recent_us[pipeline->recent_index] = time_us;
+  pipeline->recent_index = (pipeline->recent_index + 1) % PULSE_PEAK_FIT_SAMPLES;
+}
+
+// If the middle of the recent samples is the highest point of the peak so
+// far, move the peak there
+static void track_peak(pulse_pipeline_t* pipeline) {
+  uint8_t first = pipeline->recent_index;
+  uint8_t middle = (first + PULSE_PEAK_FIT_SPAN) % PULSE_PEAK_FIT_SAMPLES;
+  uint8_t last = (first + PULSE_PEAK_FIT_SAMPLES - 1) % PULSE_PEAK_FIT_SAMPLES;
+  float y0 = pipeline->recent[first];
+  float y1 = pipeline->recent[middle];
+  float y2 = pipeline->recent[last];
+  if (y1 > pipeline->peak_value && y1 >= y0 && y1 >= y2) {
+    pipeline->peak_value = y1;
+    pipeline->peak_time_us = interpolate_peak(y0, y1, y2, pipeline->recent_us[middle],
+                                              (pipeline->recent_us[last] - pipeline->recent_us[first]) / 2);
+  }
+}
+
+// Record a finished beat and update the estimate
+static void add_beat(pulse_pipeline_t* pipeline, uint32_t time_us) {
+  pipeline->rr_us = pipeline->have_beat ? time_us - pipeline->beat_time_us : 0;
+  if (pipeline->have_beat) {
+    add_interval(pipeline, pipeline->rr_us);
+  }
+  pipeline->have_beat = true;
+  pipeline->beat_time_us = time_us;
+  update_estimate(pipeline);
+}
+
+// Forget the beats after the pulse has been lost
+static void reset_beats(pulse_pipeline_t* pipeline) {
+  pipeline->have_beat = false;
+  pipeline->rr_us = 0;
+  pipeline->rr_count = 0;
+  pipeline->rr_rejected = 0;
+  update_estimate(pipeline);
+}
+
+// Reset the processing state
+void pulse_pipeline_init(pulse_pipeline_t* pipeline) {
+  memset(pipeline, 0, sizeof(*pipeline));
+  sqi_init(&pipeline->sqi);
+}
+
+// Process one raw ADC sample taken at time_us. Returns a mask of
+// PULSE_EVENT_* flags.
+uint8_t pulse_pipeline_process(pulse_pipeline_t* pipeline, float raw_sample, uint32_t time_us) {
+  uint8_t events = 0;
+
+  // Moving-average filter
+  uint8_t index = pipeline->ma_sample_count % PULSE_MA_WINDOW;
+  if (pipeline->ma_sample_count >= PULSE_MA_WINDOW) {
+    pipeline->ma_sum -= pipeline->ma_buffer[index];
+  }
+  pipeline->ma_sum += raw_sample;
+  pipeline->ma_buffer[index] = raw_sample;
+  pipeline->ma_sample_count++;
+  float filtered = (pipeline->ma_sample_count >= PULSE_MA_WINDOW) ?
+                   (pipeline->ma_sum / PULSE_MA_WINDOW) : raw_sample;
+  pipeline->filtered = filtered;
+  remember_sample(pipeline, filtered, time_us);
+
+  pipeline->elapsed_time_ms += PULSE_SAMPLE_INTERVAL_MS;
+  uint32_t now = pipeline->elapsed_time_ms;
+  if (pipeline->ma_sample_count < PULSE_MA_WINDOW) {
+    return 0;
+  }
+
+  if (sqi_add_sample(&pipeline->sqi, raw_sample, filtered)) {
+    events |= PULSE_EVENT_SQI_WINDOW;
+  }
+
+  // The pulse is lost if no valid peak has been seen for a while
+  if (pipeline->have_beat && now - pipeline->last_peak_time > PULSE_NO_PEAK_TIMEOUT_MS) {
+    reset_beats(pipeline);
+    events |= PULSE_EVENT_ESTIMATE;
+  }
+
+  // Rising edge above the threshold, at least the minimum interval after the last peak
+  if (!pipeline->peak_detected && filtered > PULSE_PEAK_THRESHOLD &&
+      now - pipeline->last_peak_time >= PULSE_MIN_PEAK_INTERVAL_MS) {
+    pipeline->last_peak_time = now;
+    pipeline->peak_detected = true;
+    pipeline->peak_value = filtered;
+    pipeline->peak_time_us = time_us;
+    sqi_add_beat(&pipeline->sqi, now);
+  } else if (pipeline->peak_detected) {
+    track_peak(pipeline);
+
+    // The beat is complete once the signal falls back below the lower threshold
+    if (filtered < PULSE_LOWER_THRESHOLD) {
+      pipeline->peak_detected = false;
+      add_beat(pipeline, pipeline->peak_time_us - PULSE_MA_DELAY_US);
+      events |= PULSE_EVENT_BEAT | PULSE_EVENT_ESTIMATE;
+    }
+  }
+
+  return events;
+}
+
+// Take the current estimate as the BPM if the signal and the estimate are
+// both good enough
+pulse_bpm_status_t pulse_pipeline_update_bpm(pulse_pipeline_t* pipeline) {
+  if (!pulse_pipeline_settled(pipeline)) {
+    return PULSE_BPM_SETTLING;
+  }
+
+  pipeline->bpm = 0;
+  if (!sqi_is_good(&pipeline->sqi)) {
+    return PULSE_BPM_LOW_QUALITY;
+  }
+  if (pipeline->estimate.confidence < PULSE_MIN_CONFIDENCE) {
+    return PULSE_BPM_NO_PULSE;
+  }
+
+  pipeline->bpm = (uint32_t)(pipeline->estimate.bpm + 0.5f);
+  return PULSE_BPM_VALID;
+}
+
+// Samples were missed before the next one: drop the peak in progress and
+// the last beat, so no beat time or RR interval is measured across the gap
+void pulse_pipeline_gap(pulse_pipeline_t* pipeline) {
+  pipeline->peak_detected = false;
+  pipeline->have_beat = false;
+  pipeline->rr_us = 0;
+}
+
+// Whether the sensor has had time to settle
+bool pulse_pipeline_settled(pulse_pipeline_t const* pipeline) {
+  return pipeline->elapsed_time_ms >= PULSE_STABILIZATION_TIME_MS;
+}
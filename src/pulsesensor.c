@@ -1,18 +1,37 @@
 #include "pulsesensor.h"
 #include <stdint.h>
+#include "app_util.h"
 
-// Pulse Sensor Output
-#define PULSE_INPUT NRF_SAADC_INPUT_AIN1
+// Pulse Sensor Outputs, one per channel (edge connector P1, P2, P0, P4)
+static const nrf_saadc_input_t pulse_inputs[] = {
+  NRF_SAADC_INPUT_AIN1,
+  NRF_SAADC_INPUT_AIN2,
+  NRF_SAADC_INPUT_AIN0,
+  NRF_SAADC_INPUT_AIN4,
+};
 
-// Channel Configurations
-#define ADC_PULSE 0
+_Static_assert(PULSE_CHANNEL_COUNT <= ARRAY_SIZE(pulse_inputs),
+               "Every pulse channel needs an analog input");
 
-// Ignore
-void saadc_event_callback(nrfx_saadc_evt_t const* _unused) {
+// Each scan is DMA'd into one buffer while the other is being handed off
+static nrf_saadc_value_t scan_buffers[2][PULSE_CHANNEL_COUNT];
+
+static adc_scan_handler_t scan_handler = NULL;
+
+// Pass each finished scan on and queue its buffer for the scan after next
+void saadc_event_callback(nrfx_saadc_evt_t const* p_event) {
+  if (p_event->type != NRFX_SAADC_EVT_DONE) {
+    return;
+  }
+  scan_handler(p_event->data.done.p_buffer);
+  ret_code_t error_code = nrfx_saadc_buffer_convert(p_event->data.done.p_buffer, PULSE_CHANNEL_COUNT);
+  APP_ERROR_CHECK(error_code);
 }
 
 // Intialize the ADC
-void adc_init(void) {
+void adc_init(adc_scan_handler_t handler) {
+  scan_handler = handler;
+
   // Set the SAADC configurations
   nrfx_saadc_config_t saadc_config = {
     .resolution = NRF_SAADC_RESOLUTION_12BIT,
@@ -24,19 +43,22 @@ void adc_init(void) {
   ret_code_t error_code = nrfx_saadc_init(&saadc_config, saadc_event_callback);
   APP_ERROR_CHECK(error_code);
 
-  // Initialize pulse sensor channel
-  nrf_saadc_channel_config_t pulse_channel_config = NRFX_SAADC_DEFAULT_CHANNEL_CONFIG_SE(PULSE_INPUT);
-  error_code = nrfx_saadc_channel_init(ADC_PULSE, &pulse_channel_config);
+  // Initialize a channel per pulse sensor; enabled channels are scanned in order
+  for (uint8_t channel = 0; channel < PULSE_CHANNEL_COUNT; channel++) {
+    nrf_saadc_channel_config_t pulse_channel_config = NRFX_SAADC_DEFAULT_CHANNEL_CONFIG_SE(pulse_inputs[channel]);
+    error_code = nrfx_saadc_channel_init(channel, &pulse_channel_config);
+    APP_ERROR_CHECK(error_code);
+  }
+
+  // Queue both scan buffers
+  error_code = nrfx_saadc_buffer_convert(scan_buffers[0], PULSE_CHANNEL_COUNT);
+  APP_ERROR_CHECK(error_code);
+  error_code = nrfx_saadc_buffer_convert(scan_buffers[1], PULSE_CHANNEL_COUNT);
   APP_ERROR_CHECK(error_code);
 }
 
-// Collect a sample
-float adc_sample_blocking(void) {
-  // read ADC counts (0-4095)
-  int16_t adc_counts = 0;
-  ret_code_t error_code = nrfx_saadc_sample_convert(ADC_PULSE, &adc_counts);
+// Start a scan of every channel. The result arrives in the scan handler.
+void adc_start_scan(void) {
+  ret_code_t error_code = nrfx_saadc_sample();
   APP_ERROR_CHECK(error_code);
-  
-  // return direct adc measurement
-  return adc_counts;
-}
\ No newline at end of file
+}
@@ -3,278 +3,514 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 #include <display.h>
 #include "max30102.h"
-#include "app_timer.h"
-#include "nrf_delay.h"
-
-// Moving average filter settings
-#define MOVING_AVG_WINDOW 10   
-static float ma_buffer[MOVING_AVG_WINDOW];  
-static uint32_t ma_sample_count = 0;        
-static float ma_sum = 0.0f;                 
-static bool ma_filled = false;        
-static bool init_display = false;    
-
-// Moving BPM average 
-#define MOVING_AVG_BPM_WINDOW 5 
-static float bpm_buffer[MOVING_AVG_BPM_WINDOW];
-static uint32_t bpm_sample_count = 0;
-static float bpm_sum = 0.0f;
-static bool bpm_buffer_filled = false;
-
-// Display update interval
-#define DISPLAY_UPDATE_INTERVAL_MS 3000  
-static uint32_t last_display_update = 0;
-
-// Peak detection thresholds
-#define PEAK_THRESHOLD        2350.0f   // Must exceed to count as a peak
-#define LOWER_THRESHOLD       2000.0f   // Must fall below before detecting a new peak
-#define MIN_PEAK_INTERVAL_MS  650       // Time between valid peaks
-
-// Sliding window for recent peak timestamps
-#define SLIDING_WINDOW_SIZE 5
-static uint32_t peak_timestamps[SLIDING_WINDOW_SIZE];
-static uint8_t  peak_count = 0;
-static uint32_t last_peak_time = 0;
-static bool peak_detected = false;  
-
-// Time threshold for resetting the sliding window if no valid peaks occur
-#define NO_PEAK_TIMEOUT_MS 5000
-
-// Timer for periodic sampling (every 2 ms)
-APP_TIMER_DEF(m_sample_timer);
-#define SAMPLE_INTERVAL_MS   2
-#define APP_TIMER_TICKS_MS(x) APP_TIMER_TICKS(x)
-static volatile uint32_t elapsed_time_ms = 0;
-#define MEASUREMENT_WINDOW_MS  30000 
-
-// Stabilization period where data is ignored for the first 5 seconds
-#define STABILIZATION_TIME_MS  5000
-
-// Start the sample timer.
-void start_sample_timer(void)
+#include "runtime.h"
+#include "session_log.h"
+#include "telemetry.h"
+#include "signal_quality.h"
+#include "metrics.h"
+#include "trends.h"
+#include "pulse_pipeline.h"
+#include "timestamp.h"
+#include "display_power.h"
+#include "boot.h"
+#include "nfc_tag.h"
+
+// One SAADC scan and the time it was started
+typedef struct {
+  uint32_t time_us;
+  bool after_gap;    // Scans were skipped just before this one
+  nrf_saadc_value_t samples[PULSE_CHANNEL_COUNT];
+} pulse_scan_t;
+
+// Scans waiting for the main loop, pushed only by the SAADC interrupt. Holds
+// a full-screen redraw's worth of scans.
+#define SCAN_QUEUE_SIZE 128
+SPSC_QUEUE_DEFINE(scan_queue, pulse_scan_t, SCAN_QUEUE_SIZE)
+static scan_queue_t scans;
+
+// Start time of the scan in progress
+static volatile uint32_t scan_time_us = 0;
+static volatile bool scan_after_gap = false;
+
+// Sampling paused around flash writes, and whether the next scan follows
+// such a pause
+static volatile bool sampling_paused = false;
+static volatile bool gap_pending = false;
+static uint32_t pause_start_us = 0;
+
+// One pipeline per pulse sensor; channel 0 drives the display, log and trends
+#define PRIMARY_CHANNEL 0
+static pulse_pipeline_t pipelines[PULSE_CHANNEL_COUNT];
+
+static bool init_display = false;
+
+// Span of the BPM trend shown on the NFC tag
+#define NFC_TREND_SPAN_S 300
+
+// Confidence needed to show a provisional BPM while the sensor settles
+#define PROVISIONAL_MIN_CONFIDENCE 30
+
+// Subscribers to BPM estimate updates
+static pulse_estimate_handler_t subscribers[PULSE_MAX_SUBSCRIBERS];
+static uint8_t subscriber_count = 0;
+
+// Latest primary estimate received by the display and the BPM on screen
+static pulse_estimate_t display_estimate;
+static uint32_t drawn_bpm = UINT32_MAX;
+static bool provisional_drawn = false;
+static bool redraw_posted = false;
+
+// Temperature currently on screen
+static int8_t drawn_temp_int = INT8_MIN;
+static uint8_t drawn_temp_frac = 0;
+
+// Rolling BPM and temperature statistics
+static trends_t trends;
+
+static void scan_done(nrf_saadc_value_t const* samples);
+static void process_scan(pulse_scan_t const* scan);
+SPSC_QUEUE_DRAIN(drain_scans, scan_queue, scans, process_scan)
+
+// Runs from the main loop: redraw for the new estimate
+static void redraw_handler(void* p_event_data, uint16_t event_size)
 {
-    ret_code_t err_code;
-    err_code = app_timer_create(&m_sample_timer,
-                                APP_TIMER_MODE_REPEATED,
-                                sample_timer_callback);
-    APP_ERROR_CHECK(err_code);
-    
-    err_code = app_timer_start(m_sample_timer, APP_TIMER_TICKS(SAMPLE_INTERVAL_MS), NULL);
-    APP_ERROR_CHECK(err_code);
-    printf("end of start_sample_timer\n");
+    redraw_posted = false;
+    display_task();
 }
 
-// Stop the sample timer.
-void stop_sample_timer(void)
+// Keep the primary estimate and redraw for it right away, so a new BPM is on
+// screen within the beat that produced it. Once a poor signal has cleared
+// the BPM, its estimates cannot change the screen and are not redrawn.
+static void display_on_estimate(uint8_t channel, pulse_estimate_t const* estimate)
 {
-    ret_code_t err_code;
-    err_code = app_timer_stop(m_sample_timer);
-    APP_ERROR_CHECK(err_code);
+    if (channel == PRIMARY_CHANNEL)
+    {
+        display_estimate = *estimate;
+        pulse_pipeline_t const* primary = &pipelines[PRIMARY_CHANNEL];
+        if (pulse_pipeline_settled(primary) && !sqi_is_good(&primary->sqi) && drawn_bpm == 0)
+        {
+            metrics_add(METRIC_SQI_REDRAWS_SKIPPED, 1);
+            return;
+        }
+        if (!redraw_posted && runtime_post(redraw_handler, NULL, 0) == NRF_SUCCESS)
+        {
+            redraw_posted = true;
+        }
+    }
 }
 
-// Compute BPM from the detected peaks using the sliding window.
-// Returns 0 if there are not enough peaks.
-static uint32_t calculate_bpm(void)
+// Stream every primary beat with its estimate
+static void telemetry_on_estimate(uint8_t channel, pulse_estimate_t const* estimate)
 {
-    if (peak_count < 2) {
-        return 0;  // Not enough peaks to calculate BPM.
-    }
-    
-    uint32_t total_interval = 0;
-    for (uint8_t i = 1; i < peak_count; i++)
+    if (channel == PRIMARY_CHANNEL)
     {
-        total_interval += (peak_timestamps[i] - peak_timestamps[i - 1]);
+        telemetry_beat(estimate->beat_time_us, (uint16_t)(estimate->bpm * 10.0f + 0.5f),
+                       (uint16_t)((estimate->bpm_high - estimate->bpm_low) * 5.0f + 0.5f),
+                       estimate->confidence);
     }
-    
-    uint32_t avg_interval_ms = total_interval / (peak_count - 1);
-    return (avg_interval_ms > 0) ? (60000 / avg_interval_ms) : 0;
 }
 
-// Called every SAMPLE_INTERVAL_MS (2 ms).
-void sample_timer_callback(void * p_context)
+// Reset the processing state and start the ADC
+void pulse_processing_init(void)
 {
-    // Read a raw ADC sample.
-    float raw_sample = adc_sample_blocking();  // ADC counts (0-4095)
+    for (uint8_t channel = 0; channel < PULSE_CHANNEL_COUNT; channel++)
+    {
+        pulse_pipeline_init(&pipelines[channel]);
+    }
+    trends_init(&trends, 0);
+    pulse_subscribe(display_on_estimate);
+    pulse_subscribe(telemetry_on_estimate);
+    runtime_add_queue(drain_scans);
+    adc_init(scan_done);
+}
 
-    // Apply a moving-average filter. 
-    uint8_t index = (uint8_t)(ma_sample_count % MOVING_AVG_WINDOW);
-    if (ma_sample_count < MOVING_AVG_WINDOW)
+// Call handler with every new BPM estimate
+void pulse_subscribe(pulse_estimate_handler_t handler)
+{
+    if (subscriber_count < PULSE_MAX_SUBSCRIBERS)
     {
-        ma_sum += raw_sample;
-        ma_buffer[index] = raw_sample;
-        ma_sample_count++;
-        if (ma_sample_count >= MOVING_AVG_WINDOW)
-        {
-            ma_filled = true;
-        }
+        subscribers[subscriber_count++] = handler;
     }
     else
     {
-        ma_sum = ma_sum - ma_buffer[index] + raw_sample;
-        ma_buffer[index] = raw_sample;
-        ma_sample_count++;
+        printf("Too many BPM subscribers\n");
     }
-    float filtered_sample = (ma_filled) ? (ma_sum / MOVING_AVG_WINDOW) : raw_sample;
-    
-    // Update elapsed time.
-    elapsed_time_ms += SAMPLE_INTERVAL_MS;
-    
-    // Skip processing during the stabilization period.
-    if (elapsed_time_ms < STABILIZATION_TIME_MS)
-    {   
+}
+
+// Sample task, run every SAMPLE_INTERVAL_MS (2 ms) from the timer interrupt.
+// Starts one SAADC scan of every channel; the result is DMA'd to RAM.
+void sample_task(void)
+{
+    if (sampling_paused)
+    {
         return;
     }
-    else {
-        if(!init_display) {
-            uint16_t white = 0xFFFF;
-            uint16_t black = 0x0000;
-
-            // Write the BPM text
-            write_text('B', white, black, 0, 0, 38, 23);
-            write_text('P', white, black, 0, 25, 38, 48);
-            write_text('M', white, black, 0, 50, 38, 73);
-            write_text(':', white, black, 0, 75, 38, 98);
-            write_text('-', white, black, 0, 100, 38, 123);
-            write_text('-', white, black, 0, 125, 38, 148);
-
-            // Write the temp text
-            write_text('T', white, black, 48, 0, 86, 23);
-            write_text('E', white, black, 48, 25, 86, 48);
-            write_text('M', white, black, 48, 50, 86, 73);
-            write_text('P', white, black, 48, 75, 86, 98);
-            write_text(':', white, black, 48, 100, 86, 123);
-            write_text('-', white, black, 48, 125, 86, 148);
-            write_text('-', white, black, 48, 150, 86, 173);
-            init_display = true;
-        }
+    scan_after_gap = gap_pending;
+    gap_pending = false;
+    scan_time_us = timestamp_us();
+    adc_start_scan();
+}
+
+// Stop sampling before an operation that stalls the CPU, such as a flash
+// write or erase. Call from the main loop.
+void pulse_sampling_pause(void)
+{
+    pause_start_us = timestamp_us();
+    sampling_paused = true;
+}
+
+// Restart sampling after pulse_sampling_pause(). The scans skipped meanwhile
+// are counted, and the pipelines are told about the gap so no beat is timed
+// across it.
+void pulse_sampling_resume(void)
+{
+    if (!sampling_paused)
+    {
+        return;
     }
-    // If no valid peak has been detected for a while, reset the sliding window.
-    if ((elapsed_time_ms - last_peak_time) > NO_PEAK_TIMEOUT_MS)
+    uint32_t paused_us = timestamp_us() - pause_start_us;
+    metrics_add(METRIC_LOG_SCANS_PAUSED, paused_us / (SAMPLE_INTERVAL_MS * 1000));
+    gap_pending = true;
+    sampling_paused = false;
+}
+
+// Runs in the SAADC interrupt when a scan finishes. Processing is deferred
+// to the main loop through the scan queue.
+static void scan_done(nrf_saadc_value_t const* samples)
+{
+    pulse_scan_t scan;
+    scan.time_us = scan_time_us;
+    scan.after_gap = scan_after_gap;
+    memcpy(scan.samples, samples, sizeof(scan.samples));
+    if (!scan_queue_push(&scans, &scan))
     {
-        peak_count = 0;  // Reset the window
+        metrics_add(METRIC_EVENTS_DROPPED, 1);
     }
-    
-    // Peak Detection 
-    // Only detect peaks if the sample is above the threshold and the peak interval has passed.
-    if (!peak_detected &&
-        (filtered_sample > PEAK_THRESHOLD) &&
-        ((elapsed_time_ms - last_peak_time) >= MIN_PEAK_INTERVAL_MS))
+}
+
+// Runs from the main loop for every queued scan, in order.
+static void process_scan(pulse_scan_t const* scan)
+{
+    boot_mark(BOOT_PHASE_FIRST_SAMPLE);
+    telemetry_raw_sample((uint16_t)scan->samples[PRIMARY_CHANNEL]);
+
+    for (uint8_t channel = 0; channel < PULSE_CHANNEL_COUNT; channel++)
     {
-        // Rising edge detected.
-        last_peak_time = elapsed_time_ms;
-        if (peak_count < SLIDING_WINDOW_SIZE)
+        pulse_pipeline_t* pipeline = &pipelines[channel];
+        if (scan->after_gap)
         {
-            peak_timestamps[peak_count++] = elapsed_time_ms;
+            pulse_pipeline_gap(pipeline);
         }
-        else
+        uint8_t events = pulse_pipeline_process(pipeline, scan->samples[channel], scan->time_us);
+        if (events & PULSE_EVENT_ESTIMATE)
         {
-            // Shift the sliding window.
-            for (uint8_t i = 0; i < SLIDING_WINDOW_SIZE - 1; i++)
+            for (uint8_t i = 0; i < subscriber_count; i++)
             {
-                peak_timestamps[i] = peak_timestamps[i + 1];
+                subscribers[i](channel, &pipeline->estimate);
             }
-            peak_timestamps[SLIDING_WINDOW_SIZE - 1] = elapsed_time_ms;
         }
-        peak_detected = true;
+        if (channel != PRIMARY_CHANNEL)
+        {
+            continue;
+        }
+
+        // Score the signal quality once per window
+        if (events & PULSE_EVENT_SQI_WINDOW)
+        {
+            metrics_set(METRIC_SQI_SCORE, sqi_score(&pipeline->sqi));
+            if (!sqi_is_good(&pipeline->sqi))
+            {
+                metrics_add(METRIC_SQI_LOW_WINDOWS, 1);
+            }
+        }
+    }
+}
+
+// Log and stream the current BPM and temperature. A poor signal logs the
+// temperature with BPM 0 (no pulse); with no temperature either, there is
+// nothing to log.
+static void publish_reading(bool good_signal)
+{
+    pulse_pipeline_t const* pipeline = &pipelines[PRIMARY_CHANNEL];
+    int8_t temp_int;
+    uint8_t temp_frac;
+    int16_t temp_centi = SESSION_LOG_NO_TEMP;
+    if (max30102_get_last_temp(&temp_int, &temp_frac))
+    {
+        temp_centi = temp_int * 100 + (temp_frac * 625) / 100;
     }
-    else if (peak_detected && (filtered_sample < LOWER_THRESHOLD))
+    uint32_t time_s = pipeline->elapsed_time_ms / 1000;
+    if (good_signal || temp_centi != SESSION_LOG_NO_TEMP)
     {
-        peak_detected = false; // Falling edge detected
+        session_log_append(time_s, pipeline->bpm, temp_centi);
     }
+    else
+    {
+        metrics_add(METRIC_SQI_LOG_SKIPPED, 1);
+    }
+
+    // Only valid readings go into the trends; gaps just leave empty buckets
+    trends_advance(&trends, time_s);
+    if (pipeline->bpm != 0)
+    {
+        trends_add(&trends, time_s, TREND_BPM, pipeline->bpm);
+    }
+    if (temp_centi != SESSION_LOG_NO_TEMP)
+    {
+        trends_add(&trends, time_s, TREND_TEMP, temp_centi);
+    }
+    telemetry_vitals(pipeline->bpm, 0, temp_centi, sqi_score(&pipeline->sqi));
+
+    // Refresh the values NFC readers see
+    trend_stat_t recent = {0};
+    trends_query(&trends, TREND_BPM, NFC_TREND_SPAN_S, &recent);
+    nfc_tag_update(pipeline->bpm, temp_centi, &recent);
+}
+
+// BPM task: update the moving BPM average of every channel from its peaks.
+void bpm_task(void)
+{
+    for (uint8_t channel = 0; channel < PULSE_CHANNEL_COUNT; channel++)
+    {
+        pulse_pipeline_t* pipeline = &pipelines[channel];
+        pulse_bpm_status_t status = pulse_pipeline_update_bpm(pipeline);
+        if (status == PULSE_BPM_SETTLING)
+        {
+            continue;
+        }
+        if (status == PULSE_BPM_VALID)
+        {
+            printf("Channel %u BPM: %lu\n", channel, pipeline->bpm);
+        }
+        if (channel != PRIMARY_CHANNEL)
+        {
+            continue;
+        }
+
+        // Poor signal skips the average; only the temperature is logged
+        if (status == PULSE_BPM_LOW_QUALITY)
+        {
+            metrics_add(METRIC_SQI_BPM_SKIPPED, 1);
+        }
+        publish_reading(status != PULSE_BPM_LOW_QUALITY);
+    }
+}
+
+// Draw the BPM and its diagnosis
+static void draw_bpm(uint32_t bpm_to_int)
+{
+    // Display the BPM 
+    write_bpm(bpm_to_int);
     
-    // Update display at fixed intervals.
-    if ((elapsed_time_ms - last_display_update) >= DISPLAY_UPDATE_INTERVAL_MS)
+    // Write the correct diagnosis to the display
+    if (bpm_to_int < 60)
+    {
+        write_text('B', 0x00F8, 0x0000, 96, 0, 134, 23);
+        write_text('R', 0x00F8, 0x0000, 96, 25, 134, 48);
+        write_text('A', 0x00F8, 0x0000, 96, 50, 134, 73);
+        write_text('D', 0x00F8, 0x0000, 96, 75, 134, 98);
+        write_text('Y', 0x00F8, 0x0000, 96, 100, 134, 123);
+        write_text('C', 0x00F8, 0x0000, 96, 125, 134, 148);
+        write_text('A', 0x00F8, 0x0000, 96, 150, 134, 173);
+        write_text('R', 0x00F8, 0x0000, 96, 175, 134, 198);
+        write_text('D', 0x00F8, 0x0000, 96, 200, 134, 223);
+        write_text('I', 0x00F8, 0x0000, 96, 225, 134, 248);
+        write_text('A', 0x00F8, 0x0000, 96, 250, 134, 273);   
+    }
+    else if (bpm_to_int > 100) {
+        write_text('T', 0x00F8, 0x0000, 96, 0, 134, 23);
+        write_text('A', 0x00F8, 0x0000, 96, 25, 134, 48);
+        write_text('C', 0x00F8, 0x0000, 96, 50, 134, 73);
+        write_text('H', 0x00F8, 0x0000, 96, 75, 134, 98);
+        write_text('Y', 0x00F8, 0x0000, 96, 100, 134, 123);
+        write_text('C', 0x00F8, 0x0000, 96, 125, 134, 148);
+        write_text('A', 0x00F8, 0x0000, 96, 150, 134, 173);
+        write_text('R', 0x00F8, 0x0000, 96, 175, 134, 198);
+        write_text('D', 0x00F8, 0x0000, 96, 200, 134, 223);
+        write_text('I', 0x00F8, 0x0000, 96, 225, 134, 248);
+        write_text('A', 0x00F8, 0x0000, 96, 250, 134, 273);   
+    }
+    else {
+        write_text('R', 0x07E0, 0x0000, 96, 0, 134, 23);
+        write_text('E', 0x07E0, 0x0000, 96, 25, 134, 48);
+        write_text('G', 0x07E0, 0x0000, 96, 50, 134, 73);
+        write_text('U', 0x07E0, 0x0000, 96, 75, 134, 98);
+        write_text('L', 0x07E0, 0x0000, 96, 100, 134, 123);
+        write_text('A', 0x07E0, 0x0000, 96, 125, 134, 148);
+        write_text('R', 0x07E0, 0x0000, 96, 150, 134, 173);
+        write_text(' ', 0x07E0, 0x0000, 96, 175, 134, 198);
+        write_text('B', 0x07E0, 0x0000, 96, 200, 134, 223);
+        write_text('P', 0x07E0, 0x0000, 96, 225, 134, 248);
+        write_text('M', 0x07E0, 0x0000, 96, 250, 134, 273);
+    }
+}
+
+// Draw a provisional BPM while the sensor settles
+static void draw_provisional_bpm(uint32_t bpm_to_int)
+{
+    write_bpm(bpm_to_int);
+    write_text('M', 0x8410, 0x0000, 96, 0, 134, 23);
+    write_text('E', 0x8410, 0x0000, 96, 25, 134, 48);
+    write_text('A', 0x8410, 0x0000, 96, 50, 134, 73);
+    write_text('S', 0x8410, 0x0000, 96, 75, 134, 98);
+    write_text('U', 0x8410, 0x0000, 96, 100, 134, 123);
+    write_text('R', 0x8410, 0x0000, 96, 125, 134, 148);
+    write_text('I', 0x8410, 0x0000, 96, 150, 134, 173);
+    write_text('N', 0x8410, 0x0000, 96, 175, 134, 198);
+    write_text('G', 0x8410, 0x0000, 96, 200, 134, 223);
+    write_text('.', 0x8410, 0x0000, 96, 225, 134, 248);
+    write_text('.', 0x8410, 0x0000, 96, 250, 134, 273);
+}
+
+// Clear the BPM and its diagnosis
+static void clear_bpm(void)
+{
+    printf("No valid pulse detected.\n");
+    write_text('-', 0xFFFF, 0x0000, 0, 100, 38, 123);
+    write_text('-', 0xFFFF, 0x0000, 0, 125, 38, 148);
+    write_text(' ', 0xFFFF, 0x0000, 96, 0, 134, 23);
+    write_text(' ', 0xFFFF, 0x0000, 96, 25, 134, 48);
+    write_text(' ', 0xFFFF, 0x0000, 96, 50, 134, 73);
+    write_text(' ', 0xFFFF, 0x0000, 96, 75, 134, 98);
+    write_text(' ', 0xFFFF, 0x0000, 96, 100, 134, 123);
+    write_text(' ', 0xFFFF, 0x0000, 96, 125, 134, 148);
+    write_text(' ', 0xFFFF, 0x0000, 96, 150, 134, 173);
+    write_text(' ', 0xFFFF, 0x0000, 96, 175, 134, 198);
+    write_text(' ', 0xFFFF, 0x0000, 96, 200, 134, 223);
+    write_text(' ', 0xFFFF, 0x0000, 96, 225, 134, 248);
+    write_text(' ', 0xFFFF, 0x0000, 96, 250, 134, 273);
+}
+
+// Display task: redraw only the readings that changed since the last run.
+// Runs after every primary estimate, and periodically for the temperature
+// and the display power timeouts.
+void display_task(void)
+{
+    pulse_pipeline_t const* primary = &pipelines[PRIMARY_CHANNEL];
+    bool settled = pulse_pipeline_settled(primary);
+
+    // Settled readings need a good signal and a confident estimate; before
+    // that, a rough estimate is shown as provisional
+    uint8_t needed = settled ? PULSE_MIN_CONFIDENCE : PROVISIONAL_MIN_CONFIDENCE;
+    uint32_t current_bpm = 0;
+    if (display_estimate.confidence >= needed && (!settled || sqi_is_good(&primary->sqi)))
+    {
+        current_bpm = (uint32_t)(display_estimate.bpm + 0.5f);
+    }
+
+    // Keep "INIT.." on screen until there is something to show
+    if (!display_is_ready() || (!settled && current_bpm == 0))
+    {
+        return;
+    }
+
+    // A valid reading keeps the display awake. While it sleeps, nothing else
+    // is redrawn; the changes are picked up on wake-up.
+    if (current_bpm != 0)
+    {
+        display_power_activity();
+    }
+    if (display_power_mode() == DISPLAY_MODE_SLEEP && current_bpm == 0)
     {
-        last_display_update = elapsed_time_ms;
-        uint32_t current_bpm = calculate_bpm();
+        display_power_update();
+        return;
+    }
+
+    if(!init_display) {
+        display_power_changed();
+        uint16_t white = 0xFFFF;
+        uint16_t black = 0x0000;
+
+        // Write the BPM text
+        write_text('B', white, black, 0, 0, 38, 23);
+        write_text('P', white, black, 0, 25, 38, 48);
+        write_text('M', white, black, 0, 50, 38, 73);
+        write_text(':', white, black, 0, 75, 38, 98);
+        write_text('-', white, black, 0, 100, 38, 123);
+        write_text('-', white, black, 0, 125, 38, 148);
+
+        // Write the temp text
+        write_text('T', white, black, 48, 0, 86, 23);
+        write_text('E', white, black, 48, 25, 86, 48);
+        write_text('M', white, black, 48, 50, 86, 73);
+        write_text('P', white, black, 48, 75, 86, 98);
+        write_text(':', white, black, 48, 100, 86, 123);
+        write_text('-', white, black, 48, 125, 86, 148);
+        write_text('-', white, black, 48, 150, 86, 173);
+        init_display = true;
+    }
+
+    // Show the provisional BPM until the sensor settles
+    if (!settled && current_bpm != drawn_bpm)
+    {
+        display_power_changed();
+        draw_provisional_bpm(current_bpm);
+        drawn_bpm = current_bpm;
+        provisional_drawn = true;
+        boot_mark(BOOT_PHASE_PROVISIONAL_BPM);
+    }
+
+    // Redraw the BPM when a new average differs from the one on screen
+    // A provisional value turning settled only changes its color, which needs
+    // full color but is not new text
+    if (settled && (current_bpm != drawn_bpm || provisional_drawn))
+    {
+        if (current_bpm != drawn_bpm)
+        {
+            display_power_changed();
+        }
+        else
+        {
+            display_power_wake();
+        }
         if (current_bpm != 0)
-        {   
-            // Update the BPM moving average. 
-            uint8_t bpm_index = bpm_sample_count % MOVING_AVG_BPM_WINDOW;
-            if (bpm_sample_count < MOVING_AVG_BPM_WINDOW)
-            {
-                bpm_sum += current_bpm;
-                bpm_buffer[bpm_index] = current_bpm; 
-                bpm_sample_count ++; 
-                if (bpm_sample_count >= MOVING_AVG_BPM_WINDOW) 
-                {
-                    bpm_buffer_filled = true; 
-                }
-            }
-            else {
-                bpm_sum = bpm_sum - bpm_buffer[bpm_index] + current_bpm; 
-                bpm_buffer[bpm_index] = current_bpm; 
-                bpm_sample_count ++; 
-            }
-            float filtered_bpm = (bpm_buffer_filled) ? (bpm_sum / MOVING_AVG_BPM_WINDOW) : (bpm_sum / bpm_sample_count); 
-            uint32_t bpm_to_int = (uint32_t) filtered_bpm;
-            printf("Current BPM: %lu\n", bpm_to_int);
-            // Display the BPM 
-            write_bpm(bpm_to_int);
-            
-            // Write the correct diagnosis to the display
-            if (bpm_to_int < 60)
-            {
-                write_text('B', 0x00F8, 0x0000, 96, 0, 134, 23);
-                write_text('R', 0x00F8, 0x0000, 96, 25, 134, 48);
-                write_text('A', 0x00F8, 0x0000, 96, 50, 134, 73);
-                write_text('D', 0x00F8, 0x0000, 96, 75, 134, 98);
-                write_text('Y', 0x00F8, 0x0000, 96, 100, 134, 123);
-                write_text('C', 0x00F8, 0x0000, 96, 125, 134, 148);
-                write_text('A', 0x00F8, 0x0000, 96, 150, 134, 173);
-                write_text('R', 0x00F8, 0x0000, 96, 175, 134, 198);
-                write_text('D', 0x00F8, 0x0000, 96, 200, 134, 223);
-                write_text('I', 0x00F8, 0x0000, 96, 225, 134, 248);
-                write_text('A', 0x00F8, 0x0000, 96, 250, 134, 273);   
-            }
-           else if (bpm_to_int > 100) {
-                write_text('T', 0x00F8, 0x0000, 96, 0, 134, 23);
-                write_text('A', 0x00F8, 0x0000, 96, 25, 134, 48);
-                write_text('C', 0x00F8, 0x0000, 96, 50, 134, 73);
-                write_text('H', 0x00F8, 0x0000, 96, 75, 134, 98);
-                write_text('Y', 0x00F8, 0x0000, 96, 100, 134, 123);
-                write_text('C', 0x00F8, 0x0000, 96, 125, 134, 148);
-                write_text('A', 0x00F8, 0x0000, 96, 150, 134, 173);
-                write_text('R', 0x00F8, 0x0000, 96, 175, 134, 198);
-                write_text('D', 0x00F8, 0x0000, 96, 200, 134, 223);
-                write_text('I', 0x00F8, 0x0000, 96, 225, 134, 248);
-                write_text('A', 0x00F8, 0x0000, 96, 250, 134, 273);   
-            }
-            else {
-                write_text('R', 0x07E0, 0x0000, 96, 0, 134, 23);
-                write_text('E', 0x07E0, 0x0000, 96, 25, 134, 48);
-                write_text('G', 0x07E0, 0x0000, 96, 50, 134, 73);
-                write_text('U', 0x07E0, 0x0000, 96, 75, 134, 98);
-                write_text('L', 0x07E0, 0x0000, 96, 100, 134, 123);
-                write_text('A', 0x07E0, 0x0000, 96, 125, 134, 148);
-                write_text('R', 0x07E0, 0x0000, 96, 150, 134, 173);
-                write_text(' ', 0x07E0, 0x0000, 96, 175, 134, 198);
-                write_text('B', 0x07E0, 0x0000, 96, 200, 134, 223);
-                write_text('P', 0x07E0, 0x0000, 96, 225, 134, 248);
-                write_text('M', 0x07E0, 0x0000, 96, 250, 134, 273);  ;
-            }
+        {
+            draw_bpm(current_bpm);
+            boot_mark(BOOT_PHASE_FIRST_BPM);
         }
         else
         {
-            printf("No valid pulse detected.\n");
-            write_text('-', 0xFFFF, 0x0000, 0, 100, 38, 123);
-            write_text('-', 0xFFFF, 0x0000, 0, 125, 38, 148);
-            write_text(' ', 0xFFFF, 0x0000, 96, 0, 134, 23);
-            write_text(' ', 0xFFFF, 0x0000, 96, 25, 134, 48);
-            write_text(' ', 0xFFFF, 0x0000, 96, 50, 134, 73);
-            write_text(' ', 0xFFFF, 0x0000, 96, 75, 134, 98);
-            write_text(' ', 0xFFFF, 0x0000, 96, 100, 134, 123);
-            write_text(' ', 0xFFFF, 0x0000, 96, 125, 134, 148);
-            write_text(' ', 0xFFFF, 0x0000, 96, 150, 134, 173);
-            write_text(' ', 0xFFFF, 0x0000, 96, 175, 134, 198);
-            write_text(' ', 0xFFFF, 0x0000, 96, 200, 134, 223);
-            write_text(' ', 0xFFFF, 0x0000, 96, 225, 134, 248);
-            write_text(' ', 0xFFFF, 0x0000, 96, 250, 134, 273);
+            clear_bpm();
         }
+        drawn_bpm = current_bpm;
+        provisional_drawn = false;
+    }
 
-        // Read the temperature
-        max30102_read_temp();
+    // Redraw the temperature when a new reading differs from the one on screen
+    int8_t temp_int;
+    uint8_t temp_frac;
+    if (max30102_get_last_temp(&temp_int, &temp_frac) &&
+        (temp_int != drawn_temp_int || temp_frac != drawn_temp_frac))
+    {
+        display_power_changed();
+        write_temp(temp_int, temp_frac);
+        drawn_temp_int = temp_int;
+        drawn_temp_frac = temp_frac;
     }
-}
\ No newline at end of file
+
+    display_power_update();
+    display_transport_update();
+}
+
+// Print BPM and temperature statistics over the last minute, hour and day.
+void pulse_report_trends(void)
+{
+    static const uint32_t spans_s[] = {60, 3600, 86400};
+    static const char* const names[TREND_METRIC_COUNT] = {"bpm", "temp", "spo2"};
+
+    for (int m = 0; m < TREND_SPO2; m++)
+    {
+        for (unsigned int i = 0; i < sizeof(spans_s) / sizeof(spans_s[0]); i++)
+        {
+            trend_stat_t stat;
+            if (trends_query(&trends, m, spans_s[i], &stat))
+            {
+                printf("trend %s %lus: min=%d max=%d mean=%d n=%u\n", names[m],
+                       (unsigned long)spans_s[i], stat.min, stat.max, stat.mean, stat.count);
+            }
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "app_scheduler.h"
+#include "app_timer.h"
+#include "nrf_pwr_mgmt.h"
+#include "runtime.h"
+#include "metrics.h"
+
+// SPSC queues drained by the main loop, in priority order
+static spsc_dispatcher_t queues;
+
+// Accounting for the current window, in app_timer ticks
+static uint32_t window_start = 0;
+static uint32_t window_idle_ticks = 0;
+static uint32_t window_wakeups = 0;
+
+// Initialize the event queue and power management.
+// Must be called after app_timer_init() since accounting uses the RTC.
+void runtime_init(void) {
+  APP_SCHED_INIT(RUNTIME_EVENT_MAX_SIZE, RUNTIME_QUEUE_SIZE);
+
+  ret_code_t err_code = nrf_pwr_mgmt_init();
+  APP_ERROR_CHECK(err_code);
+
+  window_start = app_timer_cnt_get();
+  printf("Runtime initialized!\n");
+}
+
+// Queue a handler to run from the main loop (safe to call from interrupts).
+// The payload is copied, so it may live on the caller's stack.
+ret_code_t runtime_post(app_sched_event_handler_t handler, void const* data, uint16_t size) {
+  ret_code_t err_code = app_sched_event_put(data, size, handler);
+  if (err_code != NRF_SUCCESS) {
+    metrics_add(METRIC_EVENTS_DROPPED, 1);
+  }
+  return err_code;
+}
+
+// Drain an SPSC queue from the main loop. Queues added first run first.
+void runtime_add_queue(spsc_drain_t drain) {
+  if (!spsc_dispatcher_add(&queues, drain)) {
+    printf("Too many runtime queues\n");
+  }
+}
+
+// Publish load statistics once the accounting window has elapsed
+static void update_load_window(uint32_t now) {
+  uint32_t elapsed = app_timer_cnt_diff_compute(now, window_start);
+  if (elapsed < APP_TIMER_TICKS(RUNTIME_STATS_WINDOW_MS)) {
+    return;
+  }
+
+  // Interrupt handlers run before the sleep call returns, so their time is
+  // counted as idle. Keep them short and do the real work in handlers.
+  uint32_t busy = (window_idle_ticks < elapsed) ? (elapsed - window_idle_ticks) : 0;
+  uint32_t load = (uint32_t)(((uint64_t)busy * 1000) / elapsed);
+  uint32_t wakeups = (uint32_t)(((uint64_t)window_wakeups * APP_TIMER_TICKS(1000)) / elapsed);
+  metrics_set(METRIC_CPU_LOAD_PERMILLE, load);
+  metrics_set(METRIC_WAKEUPS_PER_SEC, wakeups);
+
+  window_start = now;
+  window_idle_ticks = 0;
+  window_wakeups = 0;
+}
+
+// Run queued handlers and sleep in between. Never returns.
+void runtime_run(void) {
+  while (1) {
+    // Run every queued handler and queued item to completion, letting
+    // scheduler events in between batches of queue items
+    do {
+      app_sched_execute();
+    } while (spsc_dispatch(&queues, RUNTIME_DISPATCH_BUDGET) > 0);
+
+    // Sleep until the next event, timing how long the CPU was idle
+    uint32_t sleep_start = app_timer_cnt_get();
+    nrf_pwr_mgmt_run();
+    uint32_t sleep_end = app_timer_cnt_get();
+
+    window_idle_ticks += app_timer_cnt_diff_compute(sleep_end, sleep_start);
+    window_wakeups++;
+    update_load_window(sleep_end);
+  }
+}
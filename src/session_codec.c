@@ -0,0 +1,64 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "session_codec.h"
+
+// Map signed deltas to unsigned so small magnitudes encode in one byte
+static uint32_t zigzag_encode(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t zigzag_decode(uint32_t value) {
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// Append a varint, 7 bits per byte, low bits first
+static uint8_t* varint_encode(uint8_t* out, uint32_t value) {
+  while (value >= 0x80) {
+    *out++ = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  *out++ = (uint8_t)value;
+  return out;
+}
+
+// Read a varint. Returns NULL if it runs past end or is longer than 5 bytes.
+static uint8_t const* varint_decode(uint8_t const* in, uint8_t const* end, uint32_t* value) {
+  uint32_t result = 0;
+  for (uint8_t shift = 0; shift < 35 && in < end; shift += 7) {
+    uint8_t byte = *in++;
+    result |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      *value = result;
+      return in;
+    }
+  }
+  return NULL;
+}
+
+// Append the deltas from prev to reading. Writes at most
+// SESSION_CODEC_MAX_BYTES and returns the new end of the output.
+uint8_t* session_codec_put(uint8_t* out, session_reading_t const* prev, session_reading_t const* reading) {
+  out = varint_encode(out, zigzag_encode((int32_t)(reading->time_s - prev->time_s)));
+  out = varint_encode(out, zigzag_encode((int32_t)reading->bpm - prev->bpm));
+  out = varint_encode(out, zigzag_encode((int32_t)reading->temp_centi - prev->temp_centi));
+  return out;
+}
+
+// Apply the next deltas in [in, end) to reading, which holds the previous
+// reading. Returns where the next reading starts, or NULL if the data is
+// truncated or corrupt (reading is then unchanged).
+uint8_t const* session_codec_get(uint8_t const* in, uint8_t const* end, session_reading_t* reading) {
+  uint32_t time_delta;
+  uint32_t bpm_delta;
+  uint32_t temp_delta;
+  if ((in = varint_decode(in, end, &time_delta)) == NULL ||
+      (in = varint_decode(in, end, &bpm_delta)) == NULL ||
+      (in = varint_decode(in, end, &temp_delta)) == NULL) {
+    return NULL;
+  }
+  reading->time_s += zigzag_decode(time_delta);
+  reading->bpm += zigzag_decode(bpm_delta);
+  reading->temp_centi += zigzag_decode(temp_delta);
+  return in;
+}
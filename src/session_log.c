@@ -0,0 +1,444 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "fds.h"
+#include "nrf_pwr_mgmt.h"
+#include "session_log.h"
+#include "metrics.h"
+#include "pulsesensor_util.h"
+#include "telemetry.h"
+#include "telemetry_frame.h"
+
+// One FDS virtual page holds a 2-word page tag followed by records with a
+// 3-word header each. Four records of this size fill a page exactly.
+#define RECORD_WORDS ((FDS_VIRTUAL_PAGE_SIZE - 2) / 4 - 3)
+
+// Record key used for every session record (the file ID is the session)
+#define SESSION_RECORD_KEY 0x0001
+
+// Valid FDS file IDs
+#define SESSION_FIRST_ID 0x0001
+#define SESSION_LAST_ID  0xBFFF
+
+// Most records one session can hold: every page but the GC swap page full
+#define SESSION_MAX_RECORDS ((FDS_VIRTUAL_PAGES - 1) * 4)
+
+// Export packets offered to telemetry per storage task run
+#define EXPORT_PACKETS_PER_RUN 4
+
+// Header at the start of every record, followed by the encoded deltas
+typedef struct {
+  uint16_t seq;           // Record number within the session
+  uint16_t count;         // Readings in this record, including the first
+  uint16_t length;        // Encoded delta bytes after the header
+  uint16_t reserved;
+  session_reading_t first;
+} session_record_header_t;
+
+#define RECORD_PAYLOAD_BYTES (RECORD_WORDS * 4 - sizeof(session_record_header_t))
+
+// Record buffers: one filling, one waiting for or being written to flash
+typedef struct {
+  session_record_header_t header;
+  uint8_t payload[RECORD_PAYLOAD_BYTES];
+} session_record_t;
+
+typedef enum {
+  RECORD_FILLING,
+  RECORD_SEALED,    // Full, waiting for the storage task
+  RECORD_WRITING,   // Handed to FDS, must stay untouched until FDS_EVT_WRITE
+  RECORD_FREE,
+} record_state_t;
+
+static session_record_t records[2];
+static volatile record_state_t record_state[2] = {RECORD_FILLING, RECORD_FREE};
+static uint8_t filling = 0;
+static session_reading_t last_reading;
+
+static uint16_t session_id = SESSION_FIRST_ID;
+static uint16_t next_seq = 0;
+static volatile bool fds_init_done = false;
+static volatile ret_code_t fds_init_result = NRF_SUCCESS;
+static bool log_available = false;
+static volatile bool gc_pending = false;
+static volatile bool delete_pending = false;   // Oldest session being deleted
+static bool log_full = false;                  // Current session fills the flash
+
+static void export_step(void);
+
+// FDS event handler
+static void fds_evt_handler(fds_evt_t const* p_evt) {
+  switch (p_evt->id) {
+    case FDS_EVT_INIT:
+      fds_init_result = p_evt->result;
+      fds_init_done = true;
+      break;
+
+    case FDS_EVT_WRITE:
+      // The record buffer can be reused once FDS is done with it.
+      // Only one record is ever in flight.
+      for (int i = 0; i < 2; i++) {
+        if (record_state[i] == RECORD_WRITING) {
+          record_state[i] = (p_evt->result == NRF_SUCCESS) ? RECORD_FREE : RECORD_SEALED;
+        }
+      }
+      if (p_evt->result == NRF_SUCCESS) {
+        metrics_add(METRIC_LOG_RECORDS_WRITTEN, 1);
+      }
+      pulse_sampling_resume();
+      break;
+
+    case FDS_EVT_DEL_FILE:
+      // Only a completed delete leaves anything for GC to reclaim
+      if (p_evt->result == NRF_SUCCESS) {
+        gc_pending = true;
+      } else {
+        metrics_add(METRIC_LOG_DELETE_FAILURES, 1);
+      }
+      delete_pending = false;
+      break;
+
+    case FDS_EVT_GC:
+      pulse_sampling_resume();
+      printf("Session log garbage collected\n");
+      break;
+
+    default:
+      break;
+  }
+}
+
+// Find the highest and lowest session IDs already in flash
+static void scan_sessions(uint16_t* newest, uint16_t* oldest) {
+  fds_record_desc_t desc = {0};
+  fds_find_token_t token = {0};
+  *newest = 0;
+  *oldest = SESSION_LAST_ID;
+
+  while (fds_record_find_by_key(SESSION_RECORD_KEY, &desc, &token) == NRF_SUCCESS) {
+    fds_flash_record_t record;
+    if (fds_record_open(&desc, &record) != NRF_SUCCESS) {
+      continue;
+    }
+    uint16_t file_id = record.p_header->file_id;
+    fds_record_close(&desc);
+
+    if (file_id > *newest) {
+      *newest = file_id;
+    }
+    if (file_id < *oldest) {
+      *oldest = file_id;
+    }
+  }
+}
+
+// Start a new empty record in the given buffer
+static void start_record(uint8_t index) {
+  memset(&records[index].header, 0, sizeof(records[index].header));
+  record_state[index] = RECORD_FILLING;
+  filling = index;
+}
+
+// Seal the record being filled and move on to the other buffer.
+// Returns false (and keeps filling) if the other buffer is still in flight.
+static bool seal_record(void) {
+  uint8_t other = filling ^ 1;
+  if (record_state[other] != RECORD_FREE) {
+    return false;
+  }
+  records[filling].header.seq = next_seq++;
+  record_state[filling] = RECORD_SEALED;
+  start_record(other);
+  return true;
+}
+
+// Initialize FDS and start a new session after the newest one in flash.
+// If the flash cannot be used, the board runs on without the log.
+void session_log_init(void) {
+  ret_code_t err_code = fds_register(fds_evt_handler);
+  APP_ERROR_CHECK(err_code);
+  err_code = fds_init();
+  if (err_code == NRF_SUCCESS) {
+    while (!fds_init_done) {
+      nrf_pwr_mgmt_run();
+    }
+    err_code = fds_init_result;
+  }
+  if (err_code != NRF_SUCCESS) {
+    printf("Session log unavailable (error 0x%lX), running without it\n", err_code);
+    return;
+  }
+  log_available = true;
+
+  uint16_t newest, oldest;
+  scan_sessions(&newest, &oldest);
+  session_id = (newest >= SESSION_FIRST_ID && newest < SESSION_LAST_ID) ? newest + 1 : SESSION_FIRST_ID;
+
+  start_record(0);
+  record_state[1] = RECORD_FREE;
+  printf("Session log initialized! Session %u\n", session_id);
+}
+
+// Whether flash storage initialized, so sessions are being recorded
+bool session_log_available(void) {
+  return log_available;
+}
+
+// ID of the session being recorded
+uint16_t session_log_current(void) {
+  return session_id;
+}
+
+// Append a reading to the RAM record. Never touches flash.
+void session_log_append(uint32_t time_s, uint16_t bpm, int16_t temp_centi) {
+  if (!log_available) {
+    return;
+  }
+  if (log_full) {
+    metrics_add(METRIC_LOG_READINGS_DROPPED, 1);
+    return;
+  }
+  session_record_t* record = &records[filling];
+  session_reading_t reading = {time_s, bpm, temp_centi};
+
+  if (record->header.count > 0 && record->header.length + SESSION_CODEC_MAX_BYTES > RECORD_PAYLOAD_BYTES) {
+    if (!seal_record()) {
+      metrics_add(METRIC_LOG_READINGS_DROPPED, 1);
+      return;
+    }
+    record = &records[filling];
+  }
+
+  if (record->header.count == 0) {
+    // The first reading of a record is stored verbatim in the header
+    record->header.first = reading;
+  } else {
+    uint8_t* out = session_codec_put(&record->payload[record->header.length], &last_reading, &reading);
+    record->header.length = out - record->payload;
+  }
+  record->header.count++;
+  last_reading = reading;
+}
+
+// Delete the oldest session to make room, then compact the flash. When the
+// current session is the only one left, nothing can be freed: logging
+// stops instead of collecting garbage on every run.
+static void reclaim_space(void) {
+  fds_stat_t stat;
+  fds_stat(&stat);
+  if (stat.dirty_records == 0) {
+    uint16_t newest, oldest;
+    scan_sessions(&newest, &oldest);
+    if (oldest != session_id && oldest <= newest) {
+      printf("Session log full, deleting session %u\n", oldest);
+      if (fds_file_delete(oldest) == NRF_SUCCESS) {
+        delete_pending = true;  // GC runs once the delete completes
+      } else {
+        metrics_add(METRIC_LOG_DELETE_FAILURES, 1);  // Retried on the next run
+      }
+    } else {
+      printf("Session log full with session %u alone, logging stopped\n", session_id);
+      metrics_set(METRIC_LOG_FULL, 1);
+      log_full = true;
+    }
+    return;
+  }
+  gc_pending = true;
+}
+
+// Storage task: continue an export, write sealed records and reclaim flash
+// when needed. Runs at the lowest priority. The NVMC halts the CPU while it
+// writes a record (about 10 ms) or erases a page (about 85 ms, once per page
+// a garbage collection frees), which no interrupt can preempt. Sampling is
+// paused around each write and collection instead, so the skipped scans are
+// counted and no beat is timed across the stall.
+void storage_task(void) {
+  if (!log_available) {
+    return;
+  }
+  export_step();
+  if (log_full) {
+    return;
+  }
+  if (delete_pending) {
+    return;  // Records stay sealed until the delete has freed space
+  }
+  if (gc_pending) {
+    pulse_sampling_pause();
+    if (fds_gc() == NRF_SUCCESS) {
+      gc_pending = false;
+    } else {
+      pulse_sampling_resume();
+    }
+    return;
+  }
+
+  // Flush a partial record that has been held in RAM for too long
+  session_record_t* current = &records[filling];
+  if (current->header.count > 0 &&
+      last_reading.time_s - current->header.first.time_s >= SESSION_LOG_MAX_LATENCY_S) {
+    seal_record();
+  }
+
+  if (record_state[0] == RECORD_WRITING || record_state[1] == RECORD_WRITING) {
+    return;
+  }
+  for (int i = 0; i < 2; i++) {
+    if (record_state[i] != RECORD_SEALED) {
+      continue;
+    }
+    fds_record_t fds_record = {
+      .file_id = session_id,
+      .key = SESSION_RECORD_KEY,
+      .data.p_data = &records[i],
+      .data.length_words = (sizeof(session_record_header_t) + records[i].header.length + 3) / 4,
+    };
+    fds_record_desc_t desc = {0};
+    record_state[i] = RECORD_WRITING;
+    pulse_sampling_pause();
+    ret_code_t err_code = fds_record_write(&desc, &fds_record);
+    if (err_code != NRF_SUCCESS) {
+      pulse_sampling_resume();
+    }
+    if (err_code == FDS_ERR_NO_SPACE_IN_FLASH) {
+      record_state[i] = RECORD_SEALED;
+      reclaim_space();
+    } else if (err_code != NRF_SUCCESS) {
+      record_state[i] = RECORD_SEALED;  // Queue full, retry on the next run
+    }
+    return;
+  }
+}
+
+// Session export in progress: the session's records in sequence order,
+// found in one pass over the file, and how far the export has got
+typedef struct {
+  bool active;
+  uint16_t session;
+  uint8_t count;              // Records found
+  uint8_t record;             // Record being sent
+  uint16_t reading;           // Readings of that record already decoded
+  uint16_t offset;            // Delta bytes of that record already decoded
+  uint32_t index;             // Readings of the session already sent
+  session_reading_t last;     // Last reading decoded
+} export_state_t;
+
+static fds_record_desc_t export_records[SESSION_MAX_RECORDS];
+static export_state_t export_state;
+
+// Walk the session's file once, placing each record by its sequence number.
+// Garbage collection may have moved records out of order. Descriptors keep
+// the record's flash address, so reopening them later needs no search.
+static uint8_t find_session_records(uint16_t session) {
+  fds_record_desc_t desc = {0};
+  fds_find_token_t token = {0};
+  memset(export_records, 0, sizeof(export_records));
+
+  while (fds_record_find(session, SESSION_RECORD_KEY, &desc, &token) == NRF_SUCCESS) {
+    fds_flash_record_t flash_record;
+    if (fds_record_open(&desc, &flash_record) != NRF_SUCCESS) {
+      continue;
+    }
+    uint16_t seq = ((session_record_header_t const*)flash_record.p_data)->seq;
+    fds_record_close(&desc);
+    if (seq < SESSION_MAX_RECORDS) {
+      export_records[seq] = desc;
+    }
+  }
+
+  // Close the gaps left by records that were never written (record IDs
+  // start at 1)
+  uint8_t count = 0;
+  for (uint8_t seq = 0; seq < SESSION_MAX_RECORDS; seq++) {
+    if (export_records[seq].record_id != 0) {
+      export_records[count++] = export_records[seq];
+    }
+  }
+  return count;
+}
+
+// Decode up to max readings from the export position, advancing state.
+// A record that can no longer be opened or is corrupt ends its part early.
+static uint8_t export_decode(export_state_t* state, session_reading_t* out, uint8_t max) {
+  uint8_t decoded = 0;
+  while (decoded < max && state->record < state->count) {
+    fds_record_desc_t* desc = &export_records[state->record];
+    fds_flash_record_t flash_record;
+    uint16_t count = 0;
+    if (fds_record_open(desc, &flash_record) == NRF_SUCCESS) {
+      session_record_header_t const* header = flash_record.p_data;
+      uint8_t const* deltas = (uint8_t const*)(header + 1);
+      count = header->count;
+      while (decoded < max && state->reading < count) {
+        if (state->reading == 0) {
+          state->last = header->first;
+        } else {
+          uint8_t const* next = session_codec_get(deltas + state->offset, deltas + header->length, &state->last);
+          if (next == NULL) {
+            count = 0;
+            break;
+          }
+          state->offset = next - deltas;
+        }
+        out[decoded++] = state->last;
+        state->reading++;
+      }
+      fds_record_close(desc);
+    }
+    if (state->reading >= count) {
+      state->record++;
+      state->reading = 0;
+      state->offset = 0;
+    }
+  }
+  return decoded;
+}
+
+// Send the next few export packets, as many as telemetry takes. A packet
+// telemetry refuses is decoded again on the next run.
+static void export_step(void) {
+  uint8_t packet[6 + 8 * SESSION_LOG_EXPORT_READINGS];
+  for (int i = 0; i < EXPORT_PACKETS_PER_RUN && export_state.active; i++) {
+    export_state_t next = export_state;
+    session_reading_t readings[SESSION_LOG_EXPORT_READINGS];
+    uint8_t count = export_decode(&next, readings, SESSION_LOG_EXPORT_READINGS);
+
+    uint8_t* out = telemetry_put_u16(packet, export_state.session);
+    out = telemetry_put_u32(out, export_state.index);
+    for (uint8_t r = 0; r < count; r++) {
+      out = telemetry_put_u32(out, readings[r].time_s);
+      out = telemetry_put_u16(out, readings[r].bpm);
+      out = telemetry_put_u16(out, (uint16_t)readings[r].temp_centi);
+    }
+    // The packet without readings marks the end of the session
+    if (!telemetry_send(TELEMETRY_PKT_SESSION, packet, out - packet)) {
+      return;
+    }
+    next.index += count;
+    next.active = (count != 0);
+    export_state = next;
+  }
+}
+
+// Start streaming a stored session over telemetry, oldest reading first.
+// Readings still in RAM are not included.
+ret_code_t session_log_export(uint16_t session) {
+  if (!log_available) {
+    return NRF_ERROR_INVALID_STATE;
+  }
+  if (export_state.active) {
+    return NRF_ERROR_BUSY;
+  }
+  uint8_t count = find_session_records(session);
+  if (count == 0) {
+    return NRF_ERROR_NOT_FOUND;
+  }
+  memset(&export_state, 0, sizeof(export_state));
+  export_state.active = true;
+  export_state.session = session;
+  export_state.count = count;
+  printf("Exporting session %u (%u records)\n", session, count);
+  return NRF_SUCCESS;
+}
@@ -0,0 +1,200 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "signal_quality.h"
+
+// Clipping: samples within this many counts of the 12-bit rails.
+// Clipping flattens the peaks, so past MAX_CLIP_PERMILLE the window is bad.
+#define CLIP_MARGIN 8
+#define MAX_CLIP_PERMILLE 20
+#define ADC_MAX 4095.0f
+
+// Peak-to-peak swing expected from a finger on the sensor
+#define MIN_AMPLITUDE 150.0f
+#define MAX_AMPLITUDE 3000.0f
+
+// Plausible beat-to-beat intervals (30-200 BPM)
+#define MIN_RR_MS 300
+#define MAX_RR_MS 2000
+
+// Weight of a new beat in the running template
+#define TEMPLATE_ALPHA 0.2f
+
+// Correlation at which a beat earns full morphology points
+#define GOOD_CORRELATION 0.9f
+
+// Reset all state
+void sqi_init(sqi_t* sqi) {
+  memset(sqi, 0, sizeof(*sqi));
+  sqi->window_min = ADC_MAX;
+}
+
+// Pearson correlation of the decimated history (oldest first) with the template
+static float template_correlation(sqi_t const* sqi, float* segment) {
+  float mean_s = 0.0f;
+  float mean_t = 0.0f;
+  for (int i = 0; i < SQI_TEMPLATE_POINTS; i++) {
+    segment[i] = sqi->history[(sqi->history_index + i) % SQI_TEMPLATE_POINTS];
+    mean_s += segment[i];
+    mean_t += sqi->template_points[i];
+  }
+  mean_s /= SQI_TEMPLATE_POINTS;
+  mean_t /= SQI_TEMPLATE_POINTS;
+
+  float cov = 0.0f, var_s = 0.0f, var_t = 0.0f;
+  for (int i = 0; i < SQI_TEMPLATE_POINTS; i++) {
+    float ds = segment[i] - mean_s;
+    float dt = sqi->template_points[i] - mean_t;
+    cov += ds * dt;
+    var_s += ds * ds;
+    var_t += dt * dt;
+  }
+  if (var_s <= 0.0f || var_t <= 0.0f) {
+    return 0.0f;
+  }
+  return cov / sqrtf(var_s * var_t);
+}
+
+// Periodicity points: every recent interval within 25% of their mean
+static uint8_t periodicity_points(sqi_t const* sqi) {
+  if (sqi->rr_count < 2) {
+    return 0;
+  }
+  uint32_t sum = 0;
+  for (uint8_t i = 0; i < sqi->rr_count; i++) {
+    sum += sqi->rr_ms[i];
+  }
+  uint32_t mean = sum / sqi->rr_count;
+  uint32_t worst = 0;
+  for (uint8_t i = 0; i < sqi->rr_count; i++) {
+    uint32_t deviation = (sqi->rr_ms[i] > mean) ? sqi->rr_ms[i] - mean : mean - sqi->rr_ms[i];
+    if (deviation > worst) {
+      worst = deviation;
+    }
+  }
+  // Full points up to 10% deviation, none beyond 25%
+  uint32_t percent = worst * 100 / mean;
+  if (percent <= 10) {
+    return 25;
+  }
+  return (percent >= 25) ? 0 : (uint8_t)(25 * (25 - percent) / 15);
+}
+
+// Score the completed window and start a new one
+static void finish_window(sqi_t* sqi) {
+  float amplitude = sqi->window_max - sqi->window_min;
+  uint8_t score = 0;
+
+  // No finger (or a saturated sensor) means nothing else is meaningful
+  if (amplitude >= MIN_AMPLITUDE && amplitude <= MAX_AMPLITUDE) {
+    score += 25;
+
+    uint32_t clip_permille = (uint32_t)sqi->clipped * 1000 / sqi->window_count;
+    if (clip_permille < MAX_CLIP_PERMILLE) {
+      score += (uint8_t)(25 * (MAX_CLIP_PERMILLE - clip_permille) / MAX_CLIP_PERMILLE);
+    }
+
+    // Beats must keep coming for the interval history to count
+    sqi->missed_windows = (sqi->window_beats == 0) ? sqi->missed_windows + 1 : 0;
+    if (sqi->missed_windows < 2) {
+      score += periodicity_points(sqi);
+    }
+
+    if (sqi->template_valid && sqi->correlation > 0.0f) {
+      float points = 25.0f * sqi->correlation / GOOD_CORRELATION;
+      score += (points > 25.0f) ? 25 : (uint8_t)points;
+    }
+    if (clip_permille >= MAX_CLIP_PERMILLE && score >= SQI_GOOD_THRESHOLD) {
+      score = SQI_GOOD_THRESHOLD - 1;
+    }
+  } else {
+    sqi->rr_count = 0;
+    sqi->template_valid = false;
+  }
+
+  sqi->score = score;
+  sqi->window_count = 0;
+  sqi->clipped = 0;
+  sqi->window_beats = 0;
+  sqi->window_min = ADC_MAX;
+  sqi->window_max = 0.0f;
+}
+
+// Add one sample. Returns true when a window was completed and scored.
+bool sqi_add_sample(sqi_t* sqi, float raw, float filtered) {
+  if (raw <= CLIP_MARGIN || raw >= ADC_MAX - CLIP_MARGIN) {
+    sqi->clipped++;
+  }
+  if (filtered < sqi->window_min) {
+    sqi->window_min = filtered;
+  }
+  if (filtered > sqi->window_max) {
+    sqi->window_max = filtered;
+  }
+
+  if (++sqi->decimation == SQI_TEMPLATE_DECIMATION) {
+    sqi->decimation = 0;
+    sqi->history[sqi->history_index] = filtered;
+    sqi->history_index = (sqi->history_index + 1) % SQI_TEMPLATE_POINTS;
+  }
+
+  if (++sqi->window_count < SQI_WINDOW_SAMPLES) {
+    return false;
+  }
+  finish_window(sqi);
+  return true;
+}
+
+// Record a detected beat: update the intervals and compare its shape
+void sqi_add_beat(sqi_t* sqi, uint32_t time_ms) {
+  sqi->window_beats++;
+
+  if (sqi->last_beat_ms != 0) {
+    uint32_t rr = time_ms - sqi->last_beat_ms;
+    if (rr >= MIN_RR_MS && rr <= MAX_RR_MS) {
+      if (sqi->rr_count < SQI_RR_HISTORY) {
+        sqi->rr_ms[sqi->rr_count++] = rr;
+      } else {
+        memmove(sqi->rr_ms, sqi->rr_ms + 1, (SQI_RR_HISTORY - 1) * sizeof(uint32_t));
+        sqi->rr_ms[SQI_RR_HISTORY - 1] = rr;
+      }
+    } else {
+      sqi->rr_count = 0;
+    }
+  }
+  sqi->last_beat_ms = time_ms;
+
+  float segment[SQI_TEMPLATE_POINTS];
+  if (!sqi->template_valid) {
+    for (int i = 0; i < SQI_TEMPLATE_POINTS; i++) {
+      sqi->template_points[i] = sqi->history[(sqi->history_index + i) % SQI_TEMPLATE_POINTS];
+    }
+    sqi->template_valid = true;
+    sqi->correlation = 0.0f;
+    return;
+  }
+
+  sqi->correlation = template_correlation(sqi, segment);
+
+  // Only well-matching beats refine the template, so artifacts cannot take it over
+  if (sqi->correlation >= 0.5f) {
+    for (int i = 0; i < SQI_TEMPLATE_POINTS; i++) {
+      sqi->template_points[i] += TEMPLATE_ALPHA * (segment[i] - sqi->template_points[i]);
+    }
+  } else if (sqi->rr_count == 0) {
+    // Rhythm was lost too: start over from this beat
+    sqi->template_valid = false;
+  }
+}
+
+// Score of the last completed window (0-100)
+uint8_t sqi_score(sqi_t const* sqi) {
+  return sqi->score;
+}
+
+// Whether the signal is good enough for BPM and diagnosis
+bool sqi_is_good(sqi_t const* sqi) {
+  return sqi->score >= SQI_GOOD_THRESHOLD;
+}
@@ -0,0 +1,174 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "nrf_atomic.h"
+#include "tasks.h"
+#include "runtime.h"
+#include "metrics.h"
+#include "memory_stats.h"
+#include "max30102.h"
+#include "pulsesensor_util.h"
+#include "session_log.h"
+#include "telemetry.h"
+
+static void logging_task(void);
+
+// Static task table
+static const task_t task_table[TASK_COUNT] = {
+  //                   name           run               period_ms           prio  deadline_ms  interrupt
+  [TASK_SAMPLE]      = {"sample",      sample_task,      SAMPLE_INTERVAL_MS, 0,    2,           true},
+  [TASK_BPM]         = {"bpm",         bpm_task,         3000,               1,    500,         false},
+  [TASK_TEMPERATURE] = {"temperature", temperature_task, 2500,               2,    1000,        false},
+  [TASK_DISPLAY]     = {"display",     display_task,     2500,               3,    1000,        false},
+  [TASK_LOGGING]     = {"logging",     logging_task,     10000,              4,    5000,        false},
+  [TASK_STORAGE]     = {"storage",     storage_task,     1000,               5,    5000,        false},
+};
+
+// Single hardware timer shared by every task
+APP_TIMER_DEF(m_task_timer);
+
+// Scheduler clock, in app_timer ticks since tasks_start()
+static uint32_t clock_ticks = 0;
+static uint32_t last_rtc_count = 0;
+
+// Release bookkeeping
+static uint32_t next_release[TASK_COUNT];
+static uint32_t release_time[TASK_COUNT];
+static nrf_atomic_u32_t pending_mask = 0;
+static task_stats_t task_stats[TASK_COUNT];
+
+// Advance the scheduler clock to the current RTC count.
+// Called from both the timer interrupt and the main loop.
+static uint32_t update_clock(void) {
+  uint32_t ticks;
+  CRITICAL_REGION_ENTER();
+  uint32_t now = app_timer_cnt_get();
+  clock_ticks += app_timer_cnt_diff_compute(now, last_rtc_count);
+  last_rtc_count = now;
+  ticks = clock_ticks;
+  CRITICAL_REGION_EXIT();
+  return ticks;
+}
+
+// Runs from the main loop: execute the highest priority pending task
+static void dispatch_handler(void * p_event_data, uint16_t event_size) {
+  uint32_t pending = pending_mask;
+  int selected = -1;
+  for (int i = 0; i < TASK_COUNT; i++) {
+    if ((pending & (1UL << i)) &&
+        (selected < 0 || task_table[i].priority < task_table[selected].priority)) {
+      selected = i;
+    }
+  }
+  if (selected < 0) {
+    return;
+  }
+  nrf_atomic_u32_and(&pending_mask, ~(1UL << selected));
+
+  task_table[selected].run();
+
+  // Check the response time against the deadline
+  uint32_t response = update_clock() - release_time[selected];
+  uint32_t response_ms = (uint32_t)(((uint64_t)response * 1000) / APP_TIMER_TICKS(1000));
+  task_stats_t* stats = &task_stats[selected];
+  stats->runs++;
+  if (response_ms > stats->max_response_ms) {
+    stats->max_response_ms = response_ms;
+  }
+  if (response > APP_TIMER_TICKS(task_table[selected].deadline_ms)) {
+    stats->overruns++;
+    metrics_add(METRIC_TASK_OVERRUNS, 1);
+  }
+}
+
+// Release every task that is due and hand it to the runtime
+static void release_due_tasks(uint32_t now) {
+  for (int i = 0; i < TASK_COUNT; i++) {
+    if ((int32_t)(now - next_release[i]) < 0) {
+      continue;
+    }
+    uint32_t period = APP_TIMER_TICKS(task_table[i].period_ms);
+
+    if (task_table[i].in_interrupt) {
+      task_table[i].run();
+      task_stats[i].runs++;
+    } else if (pending_mask & (1UL << i)) {
+      // Previous release has not started yet
+      task_stats[i].skipped++;
+    } else {
+      release_time[i] = next_release[i];
+      nrf_atomic_u32_or(&pending_mask, 1UL << i);
+      runtime_post(dispatch_handler, NULL, 0);
+    }
+
+    // Catch up on any whole periods that were missed entirely
+    next_release[i] += period;
+    while ((int32_t)(now - next_release[i]) >= 0) {
+      next_release[i] += period;
+      task_stats[i].skipped++;
+    }
+  }
+}
+
+// Arm the timer for the earliest upcoming release
+static void arm_timer(uint32_t now) {
+  uint32_t timeout = UINT32_MAX;
+  for (int i = 0; i < TASK_COUNT; i++) {
+    uint32_t until = next_release[i] - now;
+    if (until < timeout) {
+      timeout = until;
+    }
+  }
+  if (timeout < APP_TIMER_MIN_TIMEOUT_TICKS) {
+    timeout = APP_TIMER_MIN_TIMEOUT_TICKS;
+  }
+  ret_code_t err_code = app_timer_start(m_task_timer, timeout, NULL);
+  APP_ERROR_CHECK(err_code);
+}
+
+// Timer interrupt: release due tasks and re-arm for the next one
+static void task_timer_callback(void * p_context) {
+  uint32_t now = update_clock();
+  release_due_tasks(now);
+  arm_timer(now);
+}
+
+// Create the scheduler timer
+void tasks_init(void) {
+  ret_code_t err_code = app_timer_create(&m_task_timer,
+                                         APP_TIMER_MODE_SINGLE_SHOT,
+                                         task_timer_callback);
+  APP_ERROR_CHECK(err_code);
+}
+
+// Start releasing tasks. Each task is first released one period from now.
+void tasks_start(void) {
+  last_rtc_count = app_timer_cnt_get();
+  clock_ticks = 0;
+  for (int i = 0; i < TASK_COUNT; i++) {
+    next_release[i] = APP_TIMER_TICKS(task_table[i].period_ms);
+  }
+  arm_timer(clock_ticks);
+  printf("Task scheduler started!\n");
+}
+
+// Print the per-task statistics
+void tasks_report(void) {
+  printf("task         runs  overruns  skipped  max_ms\n");
+  for (int i = 0; i < TASK_COUNT; i++) {
+    printf("%-11s %5lu  %8lu  %7lu  %6lu\n", task_table[i].name, task_stats[i].runs,
+           task_stats[i].overruns, task_stats[i].skipped, task_stats[i].max_response_ms);
+  }
+}
+
+// Logging task: print and stream runtime metrics and task statistics
+static void logging_task(void) {
+  memory_stats_update();
+  metrics_report();
+  tasks_report();
+  pulse_report_trends();
+  telemetry_metrics();
+}
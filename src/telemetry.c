@@ -0,0 +1,196 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "app_util_platform.h"
+#include "nrfx_uarte.h"
+#include "telemetry.h"
+#include "telemetry_frame.h"
+#include "metrics.h"
+#include "ppg_codec.h"
+
+// UARTE0 is used by printf and logging
+static const nrfx_uarte_t uarte = NRFX_UARTE_INSTANCE(1);
+
+// Double buffer: one is filled while the other is transmitted. Senders
+// reserve space in the fill buffer and encode into it outside the critical
+// region; the buffer is only handed to the UARTE once no frame is still
+// being encoded into it.
+static uint8_t tx_buffers[2][TELEMETRY_BUFFER_SIZE];
+static uint16_t tx_fill_length = 0;     // Bytes reserved in the fill buffer
+static uint8_t tx_fill_index = 0;
+static uint8_t tx_writers[2];           // Frames being encoded into each buffer
+static volatile bool tx_busy = false;
+
+// Packet sequence number, lets the receiver detect lost frames
+static uint8_t tx_seq = 0;
+
+// Index of the next raw sample
+static uint32_t raw_index = 0;
+
+#if TELEMETRY_COMPRESS_RAW
+// Compressed raw sample frame being built
+static ppg_encoder_t raw_encoder;
+static uint8_t coded_packet[4 + PPG_CODEC_MAX_FRAME_BYTES(12)];
+#else
+// Uncompressed raw sample batch
+static uint8_t raw_packet[4 + 2 * TELEMETRY_SAMPLES_PER_PACKET];
+static uint8_t raw_count = 0;
+#endif
+
+// Start transmitting the fill buffer and switch to the other one.
+// Must be called with interrupts disabled.
+static void start_tx(void) {
+  if (tx_busy || tx_fill_length == 0 || tx_writers[tx_fill_index] != 0) {
+    return;
+  }
+  nrfx_err_t err = nrfx_uarte_tx(&uarte, tx_buffers[tx_fill_index], tx_fill_length);
+  if (err != NRFX_SUCCESS) {
+    return;
+  }
+  tx_busy = true;
+  tx_fill_index ^= 1;
+  tx_fill_length = 0;
+}
+
+// UARTE event handler
+static void uarte_event_handler(nrfx_uarte_event_t const* p_event, void* p_context) {
+  if (p_event->type == NRFX_UARTE_EVT_TX_DONE) {
+    metrics_add(METRIC_TELEMETRY_BYTES_SENT, p_event->data.rxtx.bytes);
+    // Higher priority senders may be reserving space meanwhile
+    CRITICAL_REGION_ENTER();
+    tx_busy = false;
+    start_tx();
+    CRITICAL_REGION_EXIT();
+  }
+}
+
+// Initialize the UARTE at 1 Mbaud
+void telemetry_init(void) {
+  nrfx_uarte_config_t config = NRFX_UARTE_DEFAULT_CONFIG;
+  config.pseltxd = TELEMETRY_TX_PIN;
+  config.pselrxd = NRF_UARTE_PSEL_DISCONNECTED;
+  config.baudrate = NRF_UARTE_BAUDRATE_1000000;
+  config.interrupt_priority = 6;
+  nrfx_err_t err = nrfx_uarte_init(&uarte, &config, uarte_event_handler);
+  APP_ERROR_CHECK(err);
+#if TELEMETRY_COMPRESS_RAW
+  ppg_encoder_init(&raw_encoder, 12);
+#endif
+  printf("Telemetry initialized!\n");
+}
+
+// Frame and queue one packet. Safe to call from any context. Returns false
+// (and counts the drop) if the packet does not fit in the current buffer.
+// Only the space reservation and the hand-off to the UARTE run with
+// interrupts disabled; the frame is encoded in between.
+bool telemetry_send(telemetry_packet_type_t type, uint8_t const* payload, uint16_t length) {
+  uint16_t max_encoded = TELEMETRY_FRAME_MAX_BYTES(length);
+  bool reserved = false;
+  uint8_t index = 0;
+  uint16_t start = 0;
+  uint8_t seq = 0;
+
+  CRITICAL_REGION_ENTER();
+  if (tx_fill_length + max_encoded <= TELEMETRY_BUFFER_SIZE) {
+    index = tx_fill_index;
+    start = tx_fill_length;
+    seq = tx_seq++;
+    tx_fill_length += max_encoded;
+    tx_writers[index]++;
+    reserved = true;
+  }
+  CRITICAL_REGION_EXIT();
+  if (!reserved) {
+    metrics_add(METRIC_TELEMETRY_PACKETS_DROPPED, 1);
+    return false;
+  }
+
+  uint8_t* frame = &tx_buffers[index][start];
+  size_t encoded = telemetry_frame_encode(frame, type, seq, payload, length);
+  // Unused reserved bytes become extra delimiters, which receivers skip
+  memset(frame + encoded, 0x00, max_encoded - encoded);
+
+  CRITICAL_REGION_ENTER();
+  // Give the unused space back if no later frame was reserved after this one
+  if (index == tx_fill_index && start + max_encoded == tx_fill_length) {
+    tx_fill_length = start + encoded;
+  }
+  tx_writers[index]--;
+  start_tx();
+  CRITICAL_REGION_EXIT();
+  return true;
+}
+
+// Add one raw PPG sample to the batch, sending it once full
+void telemetry_raw_sample(uint16_t sample) {
+#if TELEMETRY_COMPRESS_RAW
+  if (raw_encoder.count == 0) {
+    telemetry_put_u32(coded_packet, raw_index);
+  }
+  raw_index++;
+  size_t length = ppg_encoder_push(&raw_encoder, sample, &coded_packet[4], sizeof(coded_packet) - 4);
+  if (length > 0) {
+    telemetry_send(TELEMETRY_PKT_RAW_CODED, coded_packet, 4 + length);
+  }
+#else
+  if (raw_count == 0) {
+    telemetry_put_u32(raw_packet, raw_index);
+  }
+  telemetry_put_u16(&raw_packet[4 + 2 * raw_count], sample);
+  raw_count++;
+  raw_index++;
+
+  if (raw_count == TELEMETRY_SAMPLES_PER_PACKET) {
+    telemetry_send(TELEMETRY_PKT_RAW_SAMPLES, raw_packet, sizeof(raw_packet));
+    raw_count = 0;
+  }
+#endif
+}
+
+// Send a batch of MAX30102 red/IR pairs
+void telemetry_red_ir(uint32_t first_index, uint32_t const* red, uint32_t const* ir, uint8_t count) {
+  uint8_t packet[4 + 8 * 16];
+  if (count > 16) {
+    count = 16;
+  }
+  uint8_t* out = telemetry_put_u32(packet, first_index);
+  for (uint8_t i = 0; i < count; i++) {
+    out = telemetry_put_u32(out, red[i]);
+    out = telemetry_put_u32(out, ir[i]);
+  }
+  telemetry_send(TELEMETRY_PKT_RED_IR, packet, out - packet);
+}
+
+// Send a detected beat with the BPM estimate it produced (BPM 0 when the
+// pulse was lost) and the half-width of its confidence band
+void telemetry_beat(uint32_t time_us, uint16_t bpm_tenths, uint16_t band_tenths, uint8_t confidence) {
+  uint8_t packet[9];
+  uint8_t* out = telemetry_put_u32(packet, time_us);
+  out = telemetry_put_u16(out, bpm_tenths);
+  out = telemetry_put_u16(out, band_tenths);
+  *out = confidence;
+  telemetry_send(TELEMETRY_PKT_BEAT, packet, sizeof(packet));
+}
+
+// Send the current vitals with the signal quality they were computed at
+void telemetry_vitals(uint16_t bpm, uint16_t spo2_permille, int16_t temp_centi, uint8_t quality) {
+  uint8_t packet[7];
+  uint8_t* out = telemetry_put_u16(packet, bpm);
+  out = telemetry_put_u16(out, spo2_permille);
+  out = telemetry_put_u16(out, (uint16_t)temp_centi);
+  *out = quality;
+  telemetry_send(TELEMETRY_PKT_VITALS, packet, sizeof(packet));
+}
+
+// Send every runtime metric
+void telemetry_metrics(void) {
+  uint8_t packet[5 * METRIC_COUNT];
+  uint8_t* out = packet;
+  for (int i = 0; i < METRIC_COUNT; i++) {
+    *out++ = i;
+    out = telemetry_put_u32(out, metrics_get(i));
+  }
+  telemetry_send(TELEMETRY_PKT_METRICS, packet, out - packet);
+}
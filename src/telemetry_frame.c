@@ -0,0 +1,81 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "telemetry_frame.h"
+
+// Streaming COBS encoder writing straight into the output buffer
+typedef struct {
+  uint8_t* out;
+  uint8_t* code_ptr;
+  uint8_t code;
+} cobs_encoder_t;
+
+static void cobs_start(cobs_encoder_t* enc, uint8_t* out) {
+  enc->code_ptr = out;
+  enc->out = out + 1;
+  enc->code = 1;
+}
+
+static void cobs_put(cobs_encoder_t* enc, uint8_t const* data, uint16_t length) {
+  for (uint16_t i = 0; i < length; i++) {
+    if (data[i] != 0) {
+      *enc->out++ = data[i];
+      enc->code++;
+    }
+    if (data[i] == 0 || enc->code == 0xFF) {
+      *enc->code_ptr = enc->code;
+      enc->code_ptr = enc->out++;
+      enc->code = 1;
+    }
+  }
+}
+
+// Close the last block and append the frame delimiter
+static uint8_t* cobs_finish(cobs_encoder_t* enc) {
+  *enc->code_ptr = enc->code;
+  *enc->out++ = 0x00;
+  return enc->out;
+}
+
+// CRC-16/CCITT-FALSE, identical to the SDK's crc16_compute(). Start with 0xFFFF.
+uint16_t telemetry_crc16(uint8_t const* data, size_t size, uint16_t crc) {
+  for (size_t i = 0; i < size; i++) {
+    crc = (uint8_t)(crc >> 8) | (crc << 8);
+    crc ^= data[i];
+    crc ^= (uint8_t)(crc & 0xFF) >> 4;
+    crc ^= (crc << 8) << 4;
+    crc ^= ((crc & 0xFF) << 4) << 1;
+  }
+  return crc;
+}
+
+// Encode one frame into out, which must hold TELEMETRY_FRAME_MAX_BYTES(length).
+// Returns the encoded length, including the delimiter.
+size_t telemetry_frame_encode(uint8_t* out, uint8_t type, uint8_t seq, uint8_t const* payload, uint16_t length) {
+  uint8_t header[2] = {type, seq};
+  uint16_t crc = telemetry_crc16(header, sizeof(header), 0xFFFF);
+  crc = telemetry_crc16(payload, length, crc);
+  uint8_t trailer[2];
+  telemetry_put_u16(trailer, crc);
+
+  cobs_encoder_t enc;
+  cobs_start(&enc, out);
+  cobs_put(&enc, header, sizeof(header));
+  cobs_put(&enc, payload, length);
+  cobs_put(&enc, trailer, sizeof(trailer));
+  return cobs_finish(&enc) - out;
+}
+
+uint8_t* telemetry_put_u16(uint8_t* out, uint16_t value) {
+  out[0] = value & 0xFF;
+  out[1] = value >> 8;
+  return out + 2;
+}
+
+uint8_t* telemetry_put_u32(uint8_t* out, uint32_t value) {
+  out[0] = value & 0xFF;
+  out[1] = (value >> 8) & 0xFF;
+  out[2] = (value >> 16) & 0xFF;
+  out[3] = value >> 24;
+  return out + 4;
+}
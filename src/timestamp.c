@@ -0,0 +1,32 @@
+#include "timestamp.h"
+
+#include "app_error.h"
+#include "app_util_platform.h"
+#include "nrfx_timer.h"
+
+static const nrfx_timer_t timer = NRFX_TIMER_INSTANCE(1);
+
+// Ignore; the timer runs without compare events
+static void timer_event_handler(nrf_timer_event_t event_type, void* p_context) {
+}
+
+// Start the timer
+void timestamp_init(void) {
+  nrfx_timer_config_t timer_config = NRFX_TIMER_DEFAULT_CONFIG;
+  timer_config.frequency = NRF_TIMER_FREQ_1MHz;
+  timer_config.mode = NRF_TIMER_MODE_TIMER;
+  timer_config.bit_width = NRF_TIMER_BIT_WIDTH_32;
+  ret_code_t error_code = nrfx_timer_init(&timer, &timer_config, timer_event_handler);
+  APP_ERROR_CHECK(error_code);
+  nrfx_timer_enable(&timer);
+}
+
+// Current time in microseconds. Capture and read-back must not be split by
+// an interrupt that also takes a timestamp.
+uint32_t timestamp_us(void) {
+  uint32_t time_us;
+  CRITICAL_REGION_ENTER();
+  time_us = nrfx_timer_capture(&timer, NRF_TIMER_CC_CHANNEL0);
+  CRITICAL_REGION_EXIT();
+  return time_us;
+}
@@ -0,0 +1,135 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "trends.h"
+
+// Layout of each level
+typedef struct {
+  uint32_t width_s;   // Bucket width
+  uint16_t size;      // Buckets in the ring
+  uint16_t offset;    // First bucket in trends_t.buckets
+} trend_level_t;
+
+static const trend_level_t levels[TRENDS_LEVELS] = {
+  {10,   30, 0},
+  {60,   60, 30},
+  {900,  96, 90},
+  {3600, 24, 186},
+};
+
+static void accum_reset(trend_accum_t* accum) {
+  accum->sum = 0;
+  accum->min = INT16_MAX;
+  accum->max = INT16_MIN;
+  accum->count = 0;
+}
+
+// Merge a set of statistics into an accumulator
+static void accum_merge(trend_accum_t* accum, int16_t min, int16_t max, int32_t sum, uint16_t count) {
+  if (count == 0) {
+    return;
+  }
+  accum->sum += sum;
+  accum->count += count;
+  if (min < accum->min) {
+    accum->min = min;
+  }
+  if (max > accum->max) {
+    accum->max = max;
+  }
+}
+
+// Close the current bucket of a level, cascading into coarser levels
+static void close_level(trends_t* trends, uint8_t level) {
+  trend_level_t const* info = &levels[level];
+  trend_stat_t* slot = trends->buckets[info->offset + trends->head[level]];
+
+  for (int m = 0; m < TREND_METRIC_COUNT; m++) {
+    trend_accum_t* accum = &trends->accum[level][m];
+    slot[m].count = accum->count;
+    slot[m].min = accum->min;
+    slot[m].max = accum->max;
+    slot[m].mean = accum->count ? (int16_t)(accum->sum / accum->count) : 0;
+    if (level + 1 < TRENDS_LEVELS) {
+      accum_merge(&trends->accum[level + 1][m], accum->min, accum->max, accum->sum, accum->count);
+    }
+    accum_reset(accum);
+  }
+
+  trends->head[level] = (trends->head[level] + 1) % info->size;
+  if (trends->filled[level] < info->size) {
+    trends->filled[level]++;
+  }
+  trends->closed[level]++;
+
+  // Close the coarser bucket when this one ends on its boundary
+  if (level + 1 < TRENDS_LEVELS &&
+      trends->closed[level] % (levels[level + 1].width_s / info->width_s) == 0) {
+    close_level(trends, level + 1);
+  }
+}
+
+// Start empty, with bucket boundaries counted from start_s
+void trends_init(trends_t* trends, uint32_t start_s) {
+  memset(trends, 0, sizeof(*trends));
+  for (int l = 0; l < TRENDS_LEVELS; l++) {
+    for (int m = 0; m < TREND_METRIC_COUNT; m++) {
+      accum_reset(&trends->accum[l][m]);
+    }
+  }
+  trends->bucket_end_s = start_s + levels[0].width_s;
+}
+
+// Close every bucket that ended at or before time_s
+void trends_advance(trends_t* trends, uint32_t time_s) {
+  while ((int32_t)(time_s - trends->bucket_end_s) >= 0) {
+    close_level(trends, 0);
+    trends->bucket_end_s += levels[0].width_s;
+  }
+}
+
+// Add one reading
+void trends_add(trends_t* trends, uint32_t time_s, trend_metric_t metric, int16_t value) {
+  trends_advance(trends, time_s);
+  accum_merge(&trends->accum[0][metric], value, value, value, 1);
+}
+
+// Statistics over roughly the last span_s seconds, rounded up to the bucket
+// width of the level used. Returns false if there are no readings in the span.
+bool trends_query(trends_t const* trends, trend_metric_t metric, uint32_t span_s, trend_stat_t* result) {
+  // Coarsest level that still has at least a few buckets across the span
+  uint8_t level = 0;
+  while (level + 1 < TRENDS_LEVELS && span_s >= 6 * levels[level + 1].width_s) {
+    level++;
+  }
+  trend_level_t const* info = &levels[level];
+
+  // Partial buckets in progress at this level and every finer one
+  trend_accum_t total;
+  accum_reset(&total);
+  for (uint8_t l = 0; l <= level; l++) {
+    trend_accum_t const* accum = &trends->accum[l][metric];
+    accum_merge(&total, accum->min, accum->max, accum->sum, accum->count);
+  }
+
+  // Most recent closed buckets
+  uint32_t wanted = span_s / info->width_s;
+  if (wanted > trends->filled[level]) {
+    wanted = trends->filled[level];
+  }
+  for (uint32_t i = 1; i <= wanted; i++) {
+    uint16_t index = (trends->head[level] + info->size - i) % info->size;
+    trend_stat_t const* bucket = &trends->buckets[info->offset + index][metric];
+    accum_merge(&total, bucket->min, bucket->max, (int32_t)bucket->mean * bucket->count, bucket->count);
+  }
+
+  if (total.count == 0) {
+    return false;
+  }
+  result->min = total.min;
+  result->max = total.max;
+  result->mean = (int16_t)(total.sum / total.count);
+  result->count = total.count;
+  return true;
+}
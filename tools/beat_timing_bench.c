@@ -0,0 +1,276 @@
+// Host accuracy benchmark for beat timing
+//
+// Synthesizes 12-bit pulse traces whose beats fall at known times, with
+// beat-to-beat variability and noise. It runs them through
+// src/pulse_pipeline.c and compares the detected beat times with the truth.
+// The same traces are also timed the old way (rising threshold crossing on the
+// 2 ms sample clock, BPM by integer division) for reference. A second test
+// steps the heart rate and drops one beat, and compares how fast and how
+// steadily the beat-by-beat estimate and the old 5 x 5 average follow.
+//
+// Build: gcc -std=gnu99 -O2 -Wall -Iinclude -o beat_timing_bench tools/beat_timing_bench.c tools/ppg_synth.c src/pulse_pipeline.c src/signal_quality.c -lm
+// Usage: ./beat_timing_bench [seconds]
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ppg_synth.h"
+#include "pulse_pipeline.h"
+
+#define SAMPLE_US (PULSE_SAMPLE_INTERVAL_MS * 1000)
+#define MAX_BEATS 4096
+#define BPM_BEATS 5   // Beats per BPM value in the old method
+
+// Old BPM output: a BPM_BEATS window every 3 s, averaged over 5 updates
+#define OLD_UPDATE_S 3.0
+#define OLD_AVERAGE 5
+
+// Relative amplitude of each synthetic beat
+static double beat_amplitude[MAX_BEATS];
+
+// True beat (systolic peak) times in seconds: sinusoidal respiratory
+// variation of 5% plus up to 15 ms of random jitter on every interval
+static size_t synth_beats(double* beats, double bpm, double seconds, uint32_t seed) {
+  uint32_t state = seed;
+  double t = 0.5;
+  size_t n = 0;
+  while (t < seconds && n < MAX_BEATS) {
+    beats[n] = t;
+    beat_amplitude[n] = 1.0;
+    double rr = 60.0 / bpm * (1.0 + 0.05 * sin(2 * M_PI * n / 12.0)) + 0.015 * ppg_synth_noise(&state);
+    t += rr;
+    n++;
+  }
+  return n;
+}
+
+// Sample value at time t (seconds)
+static double sample_at(double const* beats, size_t count, double t, size_t* next) {
+  while (*next < count && beats[*next] < t - 1.0) {
+    (*next)++;
+  }
+  double value = 1900;
+  for (size_t b = *next; b < count && beats[b] < t + 1.0; b++) {
+    value += 700 * beat_amplitude[b] * ppg_synth_pulse(t - beats[b]);
+  }
+  return value;
+}
+
+typedef struct {
+  const char* name;
+  double times[MAX_BEATS];   // Detected beat times (s)
+  size_t count;
+} detections_t;
+
+typedef struct {
+  size_t matched;
+  double jitter_us;     // Spread of timing error after removing the mean
+  double rr_rms_us;     // RMS error of beat-to-beat intervals
+  double bpm_mae;       // Mean absolute BPM error over BPM_BEATS beats
+} accuracy_t;
+
+// Match each detection to the nearest true beat and score the timing
+static accuracy_t score(detections_t const* d, double const* beats, size_t count, bool integer_bpm) {
+  static double error[MAX_BEATS];
+  static long index[MAX_BEATS];
+  accuracy_t a = {0};
+  size_t j = 0;
+  double mean = 0;
+
+  for (size_t i = 0; i < d->count; i++) {
+    while (j + 1 < count && fabs(beats[j + 1] - d->times[i]) < fabs(beats[j] - d->times[i])) {
+      j++;
+    }
+    index[i] = (long)j;
+    error[i] = d->times[i] - beats[j];
+    mean += error[i];
+  }
+  if (d->count == 0) {
+    return a;
+  }
+  mean /= d->count;
+  a.matched = d->count;
+
+  double var = 0, rr_sq = 0, bpm_err = 0;
+  size_t rr_n = 0, bpm_n = 0;
+  for (size_t i = 0; i < d->count; i++) {
+    var += (error[i] - mean) * (error[i] - mean);
+    if (i > 0 && index[i] == index[i - 1] + 1) {
+      double e = error[i] - error[i - 1];
+      rr_sq += e * e;
+      rr_n++;
+    }
+    if (i >= BPM_BEATS - 1 && index[i] == index[i - BPM_BEATS + 1] + BPM_BEATS - 1) {
+      double truth = 60.0 * (BPM_BEATS - 1) / (beats[index[i]] - beats[index[i - BPM_BEATS + 1]]);
+      double span = d->times[i] - d->times[i - BPM_BEATS + 1];
+      double estimate;
+      if (integer_bpm) {
+        uint32_t avg_interval_ms = (uint32_t)lround(span * 1000) / (BPM_BEATS - 1);
+        estimate = 60000 / avg_interval_ms;
+      } else {
+        estimate = 60.0 * (BPM_BEATS - 1) / span;
+      }
+      bpm_err += fabs(estimate - truth);
+      bpm_n++;
+    }
+  }
+  a.jitter_us = sqrt(var / d->count) * 1e6;
+  a.rr_rms_us = rr_n ? sqrt(rr_sq / rr_n) * 1e6 : 0;
+  a.bpm_mae = bpm_n ? bpm_err / bpm_n : 0;
+  return a;
+}
+
+static void print_row(double bpm, detections_t const* d, size_t truth, accuracy_t const* a) {
+  printf("%6.0f  %-26s %5zu/%-5zu %10.0f %10.0f %8.3f\n", bpm, d->name, a->matched, truth,
+         a->jitter_us, a->rr_rms_us, a->bpm_mae);
+}
+
+// Old method's BPM at time t from the beats detected before it
+static double old_bpm(double const* times, size_t count, double t) {
+  double sum = 0;
+  int updates = 0;
+  for (int u = 0; u < OLD_AVERAGE; u++) {
+    double tick = floor(t / OLD_UPDATE_S - u) * OLD_UPDATE_S;
+    size_t last = 0;
+    while (last < count && times[last] <= tick) {
+      last++;
+    }
+    if (last >= BPM_BEATS) {
+      sum += 60.0 * (BPM_BEATS - 1) / (times[last - 1] - times[last - BPM_BEATS]);
+      updates++;
+    }
+  }
+  return updates ? sum / updates : 0;
+}
+
+// Step from 60 to 80 BPM at 30 s, with one weak beat at about 15 s that the
+// detector misses
+static bool step_response(void) {
+  static double beats[MAX_BEATS];
+  static double times[MAX_BEATS];
+  static pulse_estimate_t estimates[MAX_BEATS];
+  const double step_s = 30;
+  uint32_t state = 5;
+  size_t count = 0;
+  for (double t = 0.5; t < 60 && count < MAX_BEATS; count++) {
+    beats[count] = t;
+    beat_amplitude[count] = (count == 15) ? 0.3 : 1.0;
+    t += 60.0 / (t < step_s ? 60 : 80) * (1.0 + 0.02 * ppg_synth_noise(&state));
+  }
+
+  pulse_pipeline_t pipeline;
+  pulse_pipeline_init(&pipeline);
+  size_t detected = 0;
+  size_t next = 0;
+  for (size_t i = 0; i < 60 * 1000000 / SAMPLE_US; i++) {
+    uint32_t time_us = (uint32_t)(i * SAMPLE_US);
+    double value = sample_at(beats, count, time_us / 1e6, &next) + 3 * ppg_synth_noise(&state);
+    uint8_t events = pulse_pipeline_process(&pipeline, (float)lround(value), time_us);
+    if ((events & PULSE_EVENT_BEAT) && detected < MAX_BEATS) {
+      times[detected] = pipeline.beat_time_us / 1e6;
+      estimates[detected++] = pipeline.estimate;
+    }
+  }
+
+  // Largest error around the missed beat, while the rate is steady
+  double new_error = 0, old_error = 0;
+  for (size_t b = 0; b < detected; b++) {
+    if (times[b] > 10 && times[b] < step_s && estimates[b].confidence >= PULSE_MIN_CONFIDENCE) {
+      new_error = fmax(new_error, fabs(estimates[b].bpm - 60));
+    }
+  }
+  for (double t = 10; t < step_s; t += 0.1) {
+    old_error = fmax(old_error, fabs(old_bpm(times, detected, t) - 60));
+  }
+
+  // Beats after the step until each output is within 2 BPM of the new rate
+  double new_delay = -1, old_delay = -1;
+  for (size_t b = 0; b < detected; b++) {
+    if (times[b] > step_s && new_delay < 0 && fabs(estimates[b].bpm - 80) <= 2 &&
+        estimates[b].confidence >= PULSE_MIN_CONFIDENCE) {
+      new_delay = times[b] - step_s;
+    }
+  }
+  for (double t = step_s; t < 60 && old_delay < 0; t += 0.1) {
+    if (fabs(old_bpm(times, detected, t) - 80) <= 2) {
+      old_delay = t - step_s;
+    }
+  }
+
+  printf("\n%-26s %14s %16s\n", "step 60->80 bpm", "reaction_s", "missed_beat_err");
+  printf("%-26s %14.1f %16.1f\n", "5 x 5 average, every 3 s", old_delay, old_error);
+  printf("%-26s %14.1f %16.1f\n", "median RR, every beat", new_delay, new_error);
+  return new_delay >= 0 && new_delay < 4 && new_error < 2;
+}
+
+int main(int argc, char** argv) {
+  static double beats[MAX_BEATS];
+  static detections_t refined = {"interpolated, us clock"};
+  static detections_t threshold = {"threshold, 2 ms clock"};
+  double seconds = (argc > 1) ? atof(argv[1]) : 300;
+  // With 5% variation, faster rates have intervals under PULSE_MIN_PEAK_INTERVAL_MS
+  static const double rates[] = {48, 60, 72, 84};
+  bool ok = true;
+
+  printf("%6s  %-26s %11s %10s %10s %8s\n", "bpm", "method", "beats", "jitter_us", "rr_rms_us",
+         "bpm_mae");
+
+  for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+    size_t count = synth_beats(beats, rates[r], seconds, 7 + r);
+    pulse_pipeline_t pipeline;
+    pulse_pipeline_init(&pipeline);
+    refined.count = 0;
+    threshold.count = 0;
+
+    // Old method state
+    bool above = false;
+    uint32_t last_rise_ms = 0;
+
+    uint32_t state = 99 + r;
+    size_t next = 0;
+    size_t samples = (size_t)(seconds * 1e6 / SAMPLE_US);
+    for (size_t i = 0; i < samples; i++) {
+      uint32_t time_us = (uint32_t)(i * SAMPLE_US);
+      double t = time_us / 1e6;
+      double value = sample_at(beats, count, t, &next) + 3 * ppg_synth_noise(&state);
+      uint8_t events = pulse_pipeline_process(&pipeline, (float)lround(value), time_us);
+      if ((events & PULSE_EVENT_BEAT) && refined.count < MAX_BEATS) {
+        refined.times[refined.count++] = pipeline.beat_time_us / 1e6;
+      }
+
+      // Rising edge on the ms sample clock, as before
+      uint32_t now_ms = pipeline.elapsed_time_ms;
+      if (now_ms < PULSE_STABILIZATION_TIME_MS) {
+        continue;
+      }
+      if (!above && pipeline.filtered > PULSE_PEAK_THRESHOLD &&
+          now_ms - last_rise_ms >= PULSE_MIN_PEAK_INTERVAL_MS) {
+        above = true;
+        last_rise_ms = now_ms;
+        if (threshold.count < MAX_BEATS) {
+          threshold.times[threshold.count++] = (now_ms - PULSE_SAMPLE_INTERVAL_MS) / 1e3;
+        }
+      } else if (above && pipeline.filtered < PULSE_LOWER_THRESHOLD) {
+        above = false;
+      }
+    }
+
+    size_t expected = 0;
+    for (size_t b = 0; b < count; b++) {
+      if (beats[b] * 1000 > PULSE_STABILIZATION_TIME_MS + 100 && beats[b] < seconds - 1) {
+        expected++;
+      }
+    }
+    accuracy_t new_accuracy = score(&refined, beats, count, false);
+    accuracy_t old_accuracy = score(&threshold, beats, count, true);
+    print_row(rates[r], &threshold, expected, &old_accuracy);
+    print_row(rates[r], &refined, expected, &new_accuracy);
+    ok &= new_accuracy.matched >= expected && new_accuracy.rr_rms_us < old_accuracy.rr_rms_us;
+  }
+  ok &= step_response();
+  return ok ? 0 : 1;
+}
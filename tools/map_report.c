@@ -0,0 +1,347 @@
+// Per-module memory report from a GNU ld map file
+//
+// Sums the input sections the linker placed for every object file and
+// archive member into text, rodata, data and bss, and prints the modules
+// ordered by the RAM they take (.data is also counted in flash, for its
+// initial values). Then the RAM budget: static data, heap and stack
+// reservations and what is left of the RAM region. Last, any libc allocator
+// code the link pulled in, and which reference pulled it in. Exits with an
+// error if the map reserves any heap.
+//
+// Build: gcc -std=gnu99 -O2 -Wall -o map_report tools/map_report.c
+// Usage: ./map_report firmware.map [modules to list, default 25]
+// Or from the top directory after building the firmware: make memory
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_MODULES 1024
+#define MAX_LINE 1024
+
+// Where RAM starts on the nRF52; sections not recognised by name are
+// classified by address
+#define RAM_START 0x20000000UL
+
+typedef enum {
+  KIND_TEXT,
+  KIND_RODATA,
+  KIND_DATA,
+  KIND_BSS,
+  KIND_COUNT,
+  KIND_HEAP,
+  KIND_STACK,
+  KIND_SKIP,
+} kind_t;
+
+typedef struct {
+  char name[128];
+  unsigned long bytes[KIND_COUNT];
+} module_t;
+
+static module_t modules[MAX_MODULES];
+static int module_count = 0;
+static unsigned long totals[KIND_COUNT];
+static unsigned long heap_bytes = 0;
+static unsigned long stack_bytes = 0;
+static unsigned long fill_ram_bytes = 0;
+static unsigned long ram_length = 0;
+
+// Allocator entry points; a member defining one of these means heap code
+static const char* const allocator_symbols[] = {
+  "malloc", "calloc", "realloc", "free", "_malloc_r", "_calloc_r",
+  "_realloc_r", "_free_r", "_sbrk", "_sbrk_r", "__wrap_malloc",
+};
+
+// Module name: the file name of the object, with its archive if any
+static void module_name(char* out, size_t size, char const* path) {
+  char const* paren = strchr(path, '(');
+  char const* end = paren ? paren : path + strlen(path);
+  char const* base = path;
+  for (char const* p = path; p < end; p++) {
+    if (*p == '/' || *p == '\\') {
+      base = p + 1;
+    }
+  }
+  snprintf(out, size, "%s", base);
+}
+
+static module_t* find_module(char const* name) {
+  for (int i = 0; i < module_count; i++) {
+    if (strcmp(modules[i].name, name) == 0) {
+      return &modules[i];
+    }
+  }
+  if (module_count == MAX_MODULES) {
+    return NULL;
+  }
+  module_t* module = &modules[module_count++];
+  snprintf(module->name, sizeof(module->name), "%s", name);
+  return module;
+}
+
+static bool starts_with(char const* s, char const* prefix) {
+  return strncmp(s, prefix, strlen(prefix)) == 0;
+}
+
+// Classify an input section by its name, falling back to its address
+static kind_t classify(char const* section, unsigned long address) {
+  if (starts_with(section, ".debug") || starts_with(section, ".comment") ||
+      starts_with(section, ".ARM.attributes") || starts_with(section, ".stab") ||
+      starts_with(section, ".note") || starts_with(section, ".gnu") ||
+      starts_with(section, ".group") || address == 0) {
+    return KIND_SKIP;
+  }
+  if (strcmp(section, ".heap") == 0) {
+    return KIND_HEAP;
+  }
+  if (strcmp(section, ".stack_dummy") == 0 || strcmp(section, ".stack") == 0) {
+    return KIND_STACK;
+  }
+  if (starts_with(section, ".bss") || starts_with(section, ".sbss") ||
+      starts_with(section, ".tbss") || strcmp(section, "COMMON") == 0 ||
+      starts_with(section, ".noinit")) {
+    return KIND_BSS;
+  }
+  if (starts_with(section, ".data") || starts_with(section, ".sdata") ||
+      starts_with(section, ".tdata")) {
+    return KIND_DATA;
+  }
+  if (starts_with(section, ".text") || starts_with(section, ".init") ||
+      starts_with(section, ".fini") || starts_with(section, ".glue_7") ||
+      starts_with(section, ".vfp11_veneer") || starts_with(section, ".v4_bx") ||
+      starts_with(section, ".iplt") || starts_with(section, ".plt") ||
+      starts_with(section, ".isr_vector")) {
+    return KIND_TEXT;
+  }
+  // Read-only data, exception tables and the SDK's named sections (logs,
+  // observers, fstorage instances)
+  return (address >= RAM_START && address < RAM_START + 0x10000000UL) ? KIND_DATA : KIND_RODATA;
+}
+
+static void add_section(char const* section, unsigned long address, unsigned long size, char const* path) {
+  kind_t kind = classify(section, address);
+  if (kind == KIND_SKIP || size == 0) {
+    return;
+  }
+  if (kind == KIND_HEAP) {
+    heap_bytes += size;
+    return;
+  }
+  if (kind == KIND_STACK) {
+    stack_bytes += size;
+    return;
+  }
+
+  char name[128];
+  module_name(name, sizeof(name), path);
+  module_t* module = find_module(name);
+  if (module != NULL) {
+    module->bytes[kind] += size;
+  }
+  totals[kind] += size;
+}
+
+static void trim_newline(char* line) {
+  size_t length = strlen(line);
+  while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+    line[--length] = '\0';
+  }
+}
+
+// Parse "0xADDR 0xSIZE path" after a section name
+static bool parse_placement(char const* text, unsigned long* address, unsigned long* size, char* path) {
+  int consumed = 0;
+  if (sscanf(text, " %lx %lx %n", address, size, &consumed) != 2 || text[consumed] == '\0') {
+    return false;
+  }
+  snprintf(path, MAX_LINE, "%s", text + consumed);
+  return true;
+}
+
+// Allocator members found, printed after the module table
+#define MAX_ALLOCATORS 32
+static char allocators[MAX_ALLOCATORS][MAX_LINE];
+static int allocator_count = 0;
+
+// "Archive member included to satisfy reference by file (symbol)" lists
+// each member, then the file and symbol that needed it
+static void check_allocator(char const* member, char const* reason) {
+  char by[MAX_LINE];
+  while (*reason == ' ') {
+    reason++;
+  }
+  snprintf(by, sizeof(by), "%s", reason);
+  char* open = strrchr(by, '(');
+  if (open == NULL || open == by || open[-1] != ' ') {
+    return;
+  }
+  open[-1] = '\0';
+  char* symbol = open + 1;
+  char* close = strchr(symbol, ')');
+  if (close != NULL) {
+    *close = '\0';
+  }
+
+  for (size_t i = 0; i < sizeof(allocator_symbols) / sizeof(allocator_symbols[0]); i++) {
+    if (strcmp(symbol, allocator_symbols[i]) == 0 && allocator_count < MAX_ALLOCATORS) {
+      char name[MAX_LINE];
+      char by_name[MAX_LINE];
+      module_name(name, sizeof(name), member);
+      module_name(by_name, sizeof(by_name), by);
+      snprintf(allocators[allocator_count++], MAX_LINE, "%.400s, for %.100s in %.400s", name, symbol, by_name);
+      return;
+    }
+  }
+}
+
+static int compare_ram(void const* a, void const* b) {
+  module_t const* x = a;
+  module_t const* y = b;
+  unsigned long ram_x = x->bytes[KIND_DATA] + x->bytes[KIND_BSS];
+  unsigned long ram_y = y->bytes[KIND_DATA] + y->bytes[KIND_BSS];
+  if (ram_x != ram_y) {
+    return ram_x < ram_y ? 1 : -1;
+  }
+  unsigned long flash_x = x->bytes[KIND_TEXT] + x->bytes[KIND_RODATA];
+  unsigned long flash_y = y->bytes[KIND_TEXT] + y->bytes[KIND_RODATA];
+  return flash_x < flash_y ? 1 : (flash_x > flash_y ? -1 : 0);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s firmware.map [modules]\n", argv[0]);
+    return 2;
+  }
+  int listed = argc > 2 ? atoi(argv[2]) : 25;
+  FILE* map = fopen(argv[1], "r");
+  if (map == NULL) {
+    perror(argv[1]);
+    return 2;
+  }
+
+  enum { BEFORE, ARCHIVES, DISCARDED, MEMORY, LAYOUT } part = BEFORE;
+  char line[MAX_LINE];
+  char pending[MAX_LINE] = "";      // Section or member name waiting for its next line
+  char path[MAX_LINE];
+  bool found_layout = false;
+
+  while (fgets(line, sizeof(line), map) != NULL) {
+    trim_newline(line);
+    if (starts_with(line, "Archive member included")) {
+      part = ARCHIVES;
+      continue;
+    } else if (starts_with(line, "Discarded input sections")) {
+      part = DISCARDED;
+      continue;
+    } else if (starts_with(line, "Memory Configuration")) {
+      part = MEMORY;
+      continue;
+    } else if (starts_with(line, "Linker script and memory map")) {
+      part = LAYOUT;
+      found_layout = true;
+      continue;
+    }
+
+    if (part == ARCHIVES) {
+      if (line[0] != ' ' && line[0] != '\0') {
+        snprintf(pending, sizeof(pending), "%s", line);
+        // Short member names share the line with the reference
+        char* gap = strstr(pending, "  ");
+        if (gap != NULL) {
+          *gap = '\0';
+          check_allocator(pending, gap + 1);
+          pending[0] = '\0';
+        }
+      } else if (pending[0] != '\0' && line[0] == ' ') {
+        check_allocator(pending, line);
+        pending[0] = '\0';
+      }
+    } else if (part == MEMORY) {
+      char region[64];
+      unsigned long origin;
+      unsigned long length;
+      if (sscanf(line, "%63s %lx %lx", region, &origin, &length) == 3 && strcmp(region, "RAM") == 0) {
+        ram_length = length;
+      }
+    } else if (part == LAYOUT) {
+      unsigned long address;
+      unsigned long size;
+      if (line[0] != ' ') {
+        // Output sections and symbol assignments
+        pending[0] = '\0';
+        continue;
+      }
+      if (starts_with(line, " *fill*")) {
+        if (sscanf(line + 7, " %lx %lx", &address, &size) == 2 && address >= RAM_START) {
+          fill_ram_bytes += size;
+        }
+        continue;
+      }
+      if (line[1] == '.' || starts_with(line, " COMMON")) {
+        char section[MAX_LINE];
+        int consumed = 0;
+        sscanf(line, " %1023s%n", section, &consumed);
+        if (parse_placement(line + consumed, &address, &size, path)) {
+          add_section(section, address, size, path);
+          pending[0] = '\0';
+        } else {
+          // Long section names put the placement on the next line
+          snprintf(pending, sizeof(pending), "%s", section);
+        }
+      } else if (pending[0] != '\0') {
+        if (parse_placement(line, &address, &size, path)) {
+          add_section(pending, address, size, path);
+        }
+        pending[0] = '\0';
+      }
+    }
+  }
+  fclose(map);
+
+  if (!found_layout) {
+    fprintf(stderr, "%s: no memory map found (link with -Wl,-Map=...)\n", argv[1]);
+    return 2;
+  }
+  qsort(modules, module_count, sizeof(modules[0]), compare_ram);
+  printf("\n%-36s %8s %8s %8s %8s %8s %8s\n", "module", "text", "rodata", "data", "bss", "flash", "ram");
+  for (int i = 0; i < module_count && i < listed; i++) {
+    module_t const* m = &modules[i];
+    printf("%-36.36s %8lu %8lu %8lu %8lu %8lu %8lu\n", m->name, m->bytes[KIND_TEXT], m->bytes[KIND_RODATA],
+           m->bytes[KIND_DATA], m->bytes[KIND_BSS],
+           m->bytes[KIND_TEXT] + m->bytes[KIND_RODATA] + m->bytes[KIND_DATA],
+           m->bytes[KIND_DATA] + m->bytes[KIND_BSS]);
+  }
+  if (module_count > listed) {
+    printf("(%d more modules)\n", module_count - listed);
+  }
+  printf("%-36s %8lu %8lu %8lu %8lu %8lu %8lu\n", "total", totals[KIND_TEXT], totals[KIND_RODATA],
+         totals[KIND_DATA], totals[KIND_BSS],
+         totals[KIND_TEXT] + totals[KIND_RODATA] + totals[KIND_DATA],
+         totals[KIND_DATA] + totals[KIND_BSS]);
+
+  unsigned long static_bytes = totals[KIND_DATA] + totals[KIND_BSS] + fill_ram_bytes;
+  printf("\nRAM budget\n");
+  printf("  static    %8lu  (.data + .bss, %lu of it alignment)\n", static_bytes, fill_ram_bytes);
+  printf("  heap      %8lu\n", heap_bytes);
+  printf("  stack     %8lu\n", stack_bytes);
+  if (ram_length != 0) {
+    long unused = (long)ram_length - (long)(static_bytes + heap_bytes + stack_bytes);
+    printf("  unused    %8ld  of %lu\n", unused, ram_length);
+  }
+
+  printf("\nAllocator code linked in:%s\n", allocator_count == 0 ? " none" : "");
+  for (int i = 0; i < allocator_count; i++) {
+    printf("  %s\n", allocators[i]);
+  }
+
+  // The firmware has no heap; a reservation means __HEAP_SIZE=0 did not
+  // reach the startup file
+  if (heap_bytes != 0) {
+    fprintf(stderr, "%s: %lu bytes reserved for the heap, expected none\n", argv[1], heap_bytes);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,308 @@
+// Host test for the NFC tag's NDEF message and update path
+//
+// Lays out the tag with src/ndef_tag.c and serves it from a mocked NFCT
+// that answers Type 4 Tag APDUs (SELECT, READ BINARY) straight from the
+// NDEF file, as the tag library does. A mocked reader goes through the
+// usual NDEF detection procedure after every update: select the NDEF
+// application, read the capability container, then read NLEN and the message
+// in MLe-sized chunks. The message is parsed and each record's text is
+// checked against the same values formatted with snprintf. Each update must
+// also change exactly the bytes it reports and nothing outside the values.
+//
+// Build: gcc -std=gnu99 -O2 -Wall -Iinclude -o nfc_tag_sim tools/nfc_tag_sim.c src/ndef_tag.c
+// Usage: ./nfc_tag_sim [updates]
+
+#define _GNU_SOURCE
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ndef_tag.h"
+
+// Largest READ BINARY response the mock sends, as in the capability container
+#define MOCK_MLE 59
+
+static ndef_tag_t tag;
+
+// Mocked NFCT: Type 4 Tag command handling over the NDEF file
+
+static const uint8_t ndef_app_name[] = {0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01};
+#define CC_FILE_ID 0xE103
+#define NDEF_FILE_ID 0xE104
+
+static bool app_selected = false;
+static uint16_t selected_file = 0;
+static uint8_t cc_file[15];
+
+static void mock_nfct_init(void) {
+  static const uint8_t cc[15] = {
+    0x00, 0x0F,                     // CCLEN
+    0x20,                           // Mapping version 2.0
+    0x00, MOCK_MLE,                 // MLe
+    0x00, 0x34,                     // MLc
+    0x04, 0x06,                     // NDEF File Control TLV
+    NDEF_FILE_ID >> 8, NDEF_FILE_ID & 0xFF,
+    NDEF_TAG_FILE_SIZE >> 8, NDEF_TAG_FILE_SIZE & 0xFF,
+    0x00,                           // Read access granted
+    0xFF,                           // No write access
+  };
+  memcpy(cc_file, cc, sizeof(cc));
+  app_selected = false;
+  selected_file = 0;
+}
+
+// Answer one C-APDU; returns the R-APDU length (data then SW1 SW2)
+static size_t mock_nfct_apdu(uint8_t const* command, size_t length, uint8_t* response) {
+  size_t n = 0;
+  uint16_t status = 0x6D00;   // Instruction not supported
+  if (length >= 5 && command[1] == 0xA4 && command[2] == 0x04) {
+    // SELECT by name
+    app_selected = command[4] == sizeof(ndef_app_name) &&
+                   memcmp(&command[5], ndef_app_name, sizeof(ndef_app_name)) == 0;
+    status = app_selected ? 0x9000 : 0x6A82;
+  } else if (length >= 7 && command[1] == 0xA4 && command[2] == 0x00) {
+    // SELECT by file identifier
+    uint16_t file = (command[5] << 8) | command[6];
+    bool found = app_selected && (file == CC_FILE_ID || file == NDEF_FILE_ID);
+    selected_file = found ? file : 0;
+    status = found ? 0x9000 : 0x6A82;
+  } else if (length == 5 && command[1] == 0xB0) {
+    // READ BINARY, straight from the selected file
+    uint16_t offset = (command[2] << 8) | command[3];
+    uint8_t const* file = (selected_file == CC_FILE_ID) ? cc_file : tag.file;
+    size_t file_size = (selected_file == CC_FILE_ID) ? sizeof(cc_file) : sizeof(tag.file);
+    size_t wanted = command[4];
+    if (selected_file == 0 || offset + wanted > file_size || wanted > MOCK_MLE) {
+      status = 0x6A82;
+    } else {
+      memcpy(response, &file[offset], wanted);
+      n = wanted;
+      status = 0x9000;
+    }
+  }
+  response[n++] = status >> 8;
+  response[n++] = status & 0xFF;
+  return n;
+}
+
+// Mocked reader: NDEF detection and read procedure
+
+static bool transceive(uint8_t const* command, size_t length, uint8_t* data, size_t* data_length) {
+  uint8_t response[MOCK_MLE + 2];
+  size_t n = mock_nfct_apdu(command, length, response);
+  if (n < 2 || response[n - 2] != 0x90 || response[n - 1] != 0x00) {
+    return false;
+  }
+  if (data != NULL) {
+    memcpy(data, response, n - 2);
+    *data_length = n - 2;
+  }
+  return true;
+}
+
+static bool select_file(uint16_t file) {
+  uint8_t command[] = {0x00, 0xA4, 0x00, 0x0C, 0x02, file >> 8, file & 0xFF};
+  return transceive(command, sizeof(command), NULL, NULL);
+}
+
+static bool read_binary(uint16_t offset, uint8_t length, uint8_t* data) {
+  uint8_t command[] = {0x00, 0xB0, offset >> 8, offset & 0xFF, length};
+  size_t got = 0;
+  return transceive(command, sizeof(command), data, &got) && got == length;
+}
+
+// Read the NDEF message; returns its length or 0 on failure
+static size_t reader_read_ndef(uint8_t* message) {
+  uint8_t select_app[5 + sizeof(ndef_app_name) + 1] = {0x00, 0xA4, 0x04, 0x00, sizeof(ndef_app_name)};
+  memcpy(&select_app[5], ndef_app_name, sizeof(ndef_app_name));
+  uint8_t cc[15];
+  if (!transceive(select_app, sizeof(select_app), NULL, NULL) || !select_file(CC_FILE_ID) ||
+      !read_binary(0, sizeof(cc), cc)) {
+    return 0;
+  }
+  uint8_t mle = cc[4];
+  uint16_t file = (cc[9] << 8) | cc[10];
+
+  uint8_t nlen[2];
+  if (!select_file(file) || !read_binary(0, 2, nlen)) {
+    return 0;
+  }
+  size_t length = (nlen[0] << 8) | nlen[1];
+  for (size_t done = 0; done < length;) {
+    uint8_t chunk = (length - done < mle) ? (uint8_t)(length - done) : mle;
+    if (!read_binary(2 + done, chunk, &message[done])) {
+      return 0;
+    }
+    done += chunk;
+  }
+  return length;
+}
+
+// Parse short English Text records into texts; returns the record count or
+// -1 if the message is malformed
+static int parse_text_records(uint8_t const* message, size_t length, char texts[][64], int max) {
+  size_t at = 0;
+  int count = 0;
+  while (at < length && count < max) {
+    uint8_t header = message[at];
+    bool first = header & 0x80;
+    bool last = header & 0x40;
+    if (first != (count == 0) || !(header & 0x10) || (header & 0x07) != 0x01 ||
+        at + 7 > length || message[at + 1] != 1 || message[at + 3] != 'T' ||
+        message[at + 4] != 0x02 || memcmp(&message[at + 5], "en", 2) != 0) {
+      return -1;
+    }
+    size_t text_length = message[at + 2] - 3;
+    if (at + 7 + text_length > length || text_length >= 64) {
+      return -1;
+    }
+    memcpy(texts[count], &message[at + 7], text_length);
+    texts[count][text_length] = '\0';
+    count++;
+    at += 7 + text_length;
+    if (last) {
+      return (at == length) ? count : -1;
+    }
+  }
+  return -1;
+}
+
+// Expected record texts, formatted independently of ndef_tag.c
+
+static void expected_texts(uint32_t bpm, int16_t temp_centi, trend_stat_t const* trend, char texts[][64]) {
+  if (bpm == 0) {
+    snprintf(texts[0], 64, "Heart rate: --- bpm");
+  } else {
+    snprintf(texts[0], 64, "Heart rate: %3u bpm", bpm);
+  }
+
+  if (temp_centi == NDEF_TAG_NO_TEMP) {
+    snprintf(texts[1], 64, "Temperature:  --.- C");
+  } else {
+    int tenths = (temp_centi >= 0) ? (temp_centi + 5) / 10 : (temp_centi - 5) / 10;
+    char value[16];
+    snprintf(value, sizeof(value), "%s%d.%d", tenths < 0 ? "-" : "", abs(tenths) / 10, abs(tenths) % 10);
+    snprintf(texts[1], 64, "Temperature: %5s C", value);
+  }
+
+  if (trend->count == 0) {
+    snprintf(texts[2], 64, "Last 5 min: min --- mean --- max --- bpm");
+  } else {
+    snprintf(texts[2], 64, "Last 5 min: min %3d mean %3d max %3d bpm", trend->min, trend->mean, trend->max);
+  }
+}
+
+// Check the reader sees exactly the expected texts
+static bool check_read(uint32_t bpm, int16_t temp_centi, trend_stat_t const* trend) {
+  uint8_t message[NDEF_TAG_FILE_SIZE];
+  char texts[3][64];
+  char expected[3][64];
+  size_t length = reader_read_ndef(message);
+  if (length == 0 || parse_text_records(message, length, texts, 3) != 3) {
+    printf("malformed NDEF message\n");
+    return false;
+  }
+  expected_texts(bpm, temp_centi, trend, expected);
+  for (int i = 0; i < 3; i++) {
+    if (strcmp(texts[i], expected[i]) != 0) {
+      printf("record %d: \"%s\", expected \"%s\"\n", i, texts[i], expected[i]);
+      return false;
+    }
+  }
+  return true;
+}
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char** argv) {
+  int updates = (argc > 1) ? atoi(argv[1]) : 10000;
+  bool ok = true;
+
+  ndef_tag_init(&tag);
+  mock_nfct_init();
+  uint16_t message_size = tag.size - 2;
+
+  // Freshly laid out: every value is dashes
+  trend_stat_t trend = {0};
+  ok &= check_read(0, NDEF_TAG_NO_TEMP, &trend);
+
+  uint8_t texts_shown = 0;
+  uint64_t patched_total = 0;
+  uint32_t stray_bytes = 0;
+  uint32_t state = 1;
+  for (int i = 0; i < updates && ok; i++) {
+    // Readings that drift like a resting wearer, with occasional gaps and
+    // out-of-range values
+    state = state * 1103515245u + 12345u;
+    uint32_t r = state >> 8;
+    uint32_t bpm = (r % 50 == 0) ? 0 : 60 + (i / 7) % 40 + r % 3;
+    if (r % 997 == 0) {
+      bpm = 1234;
+    }
+    int16_t temp_centi = (r % 60 == 1) ? NDEF_TAG_NO_TEMP : (int16_t)(3300 + (i / 11) % 400 - (int)(r % 7));
+    if (r % 501 == 0) {
+      temp_centi = -45;
+    }
+    trend.count = (r % 40 == 2) ? 0 : 100;
+    trend.min = (int16_t)(bpm ? bpm - 4 : 55);
+    trend.max = (int16_t)(bpm ? bpm + 6 : 95);
+    trend.mean = (int16_t)((trend.min + trend.max) / 2);
+
+    uint8_t before[NDEF_TAG_FILE_SIZE];
+    memcpy(before, tag.file, sizeof(before));
+    uint32_t patched = ndef_tag_set_bpm(&tag, bpm);
+    patched += ndef_tag_set_temp(&tag, temp_centi);
+    patched += ndef_tag_set_trend(&tag, &trend);
+    patched_total += patched;
+
+    // Exactly the reported bytes changed, and only inside the values
+    uint32_t changed = 0;
+    for (size_t b = 0; b < sizeof(before); b++) {
+      if (before[b] != tag.file[b]) {
+        changed++;
+        bool in_value = (b >= tag.bpm_field && b < tag.bpm_field + 3) ||
+                        (b >= tag.temp_field && b < tag.temp_field + 5) ||
+                        (b >= tag.trend_field && b < tag.trend_field + 24);
+        stray_bytes += !in_value;
+      }
+    }
+    ok &= changed == patched && stray_bytes == 0;
+
+    // Out-of-range values are starred instead of corrupting the layout
+    if (bpm == 1234 || temp_centi == -45) {
+      uint8_t message[NDEF_TAG_FILE_SIZE];
+      char texts[3][64];
+      size_t length = reader_read_ndef(message);
+      ok &= length == message_size && parse_text_records(message, length, texts, 3) == 3;
+      if (texts_shown++ < 2) {
+        printf("%s | %s | %s\n", texts[0], texts[1], texts[2]);
+      }
+    } else {
+      ok &= check_read(bpm, temp_centi, &trend);
+    }
+  }
+
+  // Cost of one update of all three values
+  double start = now_ns();
+  for (int i = 0; i < updates; i++) {
+    trend.mean = (int16_t)(60 + i % 40);
+    ndef_tag_set_bpm(&tag, 60 + i % 40);
+    ndef_tag_set_temp(&tag, (int16_t)(3300 + i % 400));
+    ndef_tag_set_trend(&tag, &trend);
+  }
+  double update_ns = (now_ns() - start) / updates;
+
+  printf("message: %u bytes in a %u-byte file, 3 text records\n", message_size, NDEF_TAG_FILE_SIZE);
+  printf("updates: %d, %.1f bytes patched per update (vs %u to rebuild), %u stray bytes\n",
+         updates, (double)patched_total / updates, message_size, stray_bytes);
+  printf("update cost: %.0f ns\n", update_ns);
+  printf("%s\n", ok ? "passed" : "FAILED");
+  return ok ? 0 : 1;
+}
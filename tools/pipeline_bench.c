@@ -0,0 +1,114 @@
+// Host benchmark for the pulse processing pipeline
+//
+// Runs one src/pulse_pipeline.c instance per channel over synthetic 12-bit
+// pulse sensor traces, the way the firmware handles each SAADC scan, and
+// reports how the processing cost grows with the number of channels. Each
+// channel gets a different heart rate so the reported BPM also shows the
+// instances stay independent.
+//
+// Build: gcc -std=gnu99 -O2 -Wall -Iinclude -o pipeline_bench tools/pipeline_bench.c tools/ppg_synth.c src/pulse_pipeline.c src/signal_quality.c -lm
+// Usage: ./pipeline_bench [seconds]
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ppg_synth.h"
+#include "pulse_pipeline.h"
+
+#define MAX_CHANNELS 8
+#define SAMPLE_RATE_HZ (1000 / PULSE_SAMPLE_INTERVAL_MS)
+#define BPM_PERIOD_SAMPLES (3000 / PULSE_SAMPLE_INTERVAL_MS)
+#define REPEATS 5
+
+// Channel heart rate: 55, 60, 65, ... 90 BPM, below the limit set by
+// PULSE_MIN_PEAK_INTERVAL_MS
+static double channel_bpm(int channel) {
+  return 55.0 + 5.0 * channel;
+}
+
+// Interleaved scans, one 12-bit sample per channel, as the SAADC delivers them
+static int16_t* synth_scans(int channels, size_t scans) {
+  int16_t* x = malloc(scans * channels * sizeof(int16_t));
+  uint32_t state = 1;
+  for (size_t i = 0; i < scans; i++) {
+    double t = (double)i / SAMPLE_RATE_HZ;
+    for (int c = 0; c < channels; c++) {
+      double value = 1900 + 700 * ppg_synth_steady(t, channel_bpm(c)) + 40 * sin(2 * M_PI * 0.2 * t) + 4 * ppg_synth_noise(&state);
+      x[i * channels + c] = (int16_t)lround(value);
+    }
+  }
+  return x;
+}
+
+// Process every scan through one pipeline per channel
+static void run(pulse_pipeline_t* pipelines, int channels, int16_t const* x, size_t scans) {
+  for (int c = 0; c < channels; c++) {
+    pulse_pipeline_init(&pipelines[c]);
+  }
+  for (size_t i = 0; i < scans; i++) {
+    for (int c = 0; c < channels; c++) {
+      pulse_pipeline_process(&pipelines[c], x[i * channels + c], (uint32_t)(i * PULSE_SAMPLE_INTERVAL_MS * 1000));
+    }
+    if ((i + 1) % BPM_PERIOD_SAMPLES == 0) {
+      for (int c = 0; c < channels; c++) {
+        pulse_pipeline_update_bpm(&pipelines[c]);
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  static pulse_pipeline_t pipelines[MAX_CHANNELS];
+  int seconds = (argc > 1) ? atoi(argv[1]) : 120;
+  size_t scans = (size_t)seconds * SAMPLE_RATE_HZ;
+  bool ok = true;
+
+  printf("%8s %10s %10s %10s %10s  %s\n", "channels", "ns/scan", "ns/sample", "cyc/sample",
+         "bytes", "bpm (expected)");
+
+  for (int channels = 1; channels <= MAX_CHANNELS; channels *= 2) {
+    int16_t* x = synth_scans(channels, scans);
+
+    // Best of several passes
+    double best_ns = 1e30;
+    uint64_t best_cycles = UINT64_MAX;
+    for (int rep = 0; rep < REPEATS; rep++) {
+      double start = ppg_synth_now_ns();
+#ifdef PPG_SYNTH_HAVE_CYCLES
+      uint64_t cycles_start = ppg_synth_cycles();
+#endif
+      run(pipelines, channels, x, scans);
+#ifdef PPG_SYNTH_HAVE_CYCLES
+      uint64_t cycles = ppg_synth_cycles() - cycles_start;
+      if (cycles < best_cycles) {
+        best_cycles = cycles;
+      }
+#endif
+      double elapsed = ppg_synth_now_ns() - start;
+      if (elapsed < best_ns) {
+        best_ns = elapsed;
+      }
+    }
+
+    printf("%8d %10.1f %10.1f", channels, best_ns / scans, best_ns / (scans * channels));
+#ifdef PPG_SYNTH_HAVE_CYCLES
+    printf(" %10.1f", (double)best_cycles / (scans * channels));
+#else
+    printf(" %10s", "n/a");
+#endif
+    printf(" %10zu ", channels * sizeof(pulse_pipeline_t));
+    for (int c = 0; c < channels; c++) {
+      uint32_t expected = (uint32_t)channel_bpm(c);
+      bool close = abs((int)pipelines[c].bpm - (int)expected) <= 2;
+      printf(" %lu(%lu)%s", (unsigned long)pipelines[c].bpm, (unsigned long)expected, close ? "" : "!");
+      ok &= close;
+    }
+    printf("\n");
+    free(x);
+  }
+  return ok ? 0 : 1;
+}
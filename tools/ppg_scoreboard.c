@@ -0,0 +1,376 @@
+// Host accuracy and throughput scoreboard for the pulse pipeline
+//
+// Generates deterministic 12-bit pulse sensor traces with known beat times,
+// from the shared generator in tools/ppg_synth.c, and runs them through
+// src/pulse_pipeline.c exactly as the firmware does for each SAADC scan.
+// Every scenario combines a heart rate profile (steady, step or ramp) with
+// optional irregular or ectopic RR intervals, respiratory baseline wander,
+// motion artifact bursts, clipping at the ADC rails and white noise. For each scenario the scoreboard reports:
+//
+//   bpm_mae   Mean absolute error of confident estimates, against the mean
+//             true rate over the 5 s before each estimate's beat
+//   cover     Share of time after settling with a confident estimate
+//   se, ppv   Beat sensitivity and positive predictivity, matching detections
+//             to true systolic peaks within 150 ms
+//   latency   Mean delay from a true peak to its detection event
+//   ns        Pipeline processing time per sample on this host
+//
+// Given a results file, the previous run's numbers are read from it, the
+// change is printed, and the file is replaced with this run's results.
+//
+// Build: gcc -std=gnu99 -O2 -Wall -Iinclude -o ppg_scoreboard tools/ppg_scoreboard.c tools/ppg_synth.c src/pulse_pipeline.c src/signal_quality.c -lm
+// Usage: ./ppg_scoreboard [-s seconds] [results.tsv]
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ppg_synth.h"
+#include "pulse_pipeline.h"
+
+#define SAMPLE_US (PULSE_SAMPLE_INTERVAL_MS * 1000)
+#define MAX_SECONDS 600
+#define MAX_SAMPLES (MAX_SECONDS * 1000000 / SAMPLE_US)
+#define MAX_BEATS (MAX_SECONDS * 4)
+
+#define ADC_MAX 4095          // 12-bit SAADC
+#define MATCH_WINDOW_S 0.15   // Detection to true peak tolerance
+#define TRUTH_WINDOW_S 5.0    // Span of the reference rate
+
+typedef struct {
+  const char* name;
+  double bpm_start;         // Rate at the start, and at the end of a ramp
+  double bpm_end;           // or after a step
+  double step_s;            // Step time; 0 ramps from start to end instead
+  double rr_jitter;         // Random RR variation, as a fraction (1 sigma)
+  int ectopic_every;        // Every nth beat is premature, 0 for none
+  double amplitude;         // Pulse height in counts
+  double baseline;          // DC level in counts
+  double wander_counts;     // Respiratory baseline wander amplitude
+  double noise_counts;      // White noise RMS
+  double motion_counts;     // Motion artifact amplitude, 0 for none
+  uint32_t seed;
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+  // name                    start  end  step  jitter ect  amp   base  wand noise motion seed
+  {"steady 72",               72,   72,   1,   0.02,  0,   700, 1900,   0,   3,    0,  1},
+  {"step 60->85",             60,   85,  60,   0.02,  0,   700, 1900,   0,   3,    0,  2},
+  {"ramp 55->90",             55,   90,   0,   0.02,  0,   700, 1900,   0,   3,    0,  3},
+  {"irregular RR 15%",        75,   75,   1,   0.15,  0,   700, 1900,   0,   3,    0,  4},
+  {"ectopic every 8th",       70,   70,   1,   0.02,  8,   700, 1900,   0,   3,    0,  5},
+  {"baseline wander 200",     72,   72,   1,   0.02,  0,   700, 1900, 200,   3,    0,  6},
+  {"motion artifacts",        72,   72,   1,   0.02,  0,   700, 1900,   0,   3, 1500,  7},
+  {"clipping",                72,   72,   1,   0.02,  0,  2600, 1900,   0,   3,    0,  8},
+  {"noise 40 rms",            72,   72,   1,   0.02,  0,   700, 1900,   0,  40,    0,  9},
+  {"weak pulse",              72,   72,   1,   0.02,  0,   500, 1900,   0,   3,    0, 10},
+};
+#define SCENARIO_COUNT (sizeof(scenarios) / sizeof(scenarios[0]))
+
+typedef struct {
+  double bpm_mae;
+  double coverage;
+  double sensitivity;
+  double predictivity;
+  double latency_ms;
+  double ns_per_sample;
+} score_t;
+
+// Generated trace and its ground truth
+static float samples[MAX_SAMPLES];
+static double beats[MAX_BEATS];
+static double beat_amplitude[MAX_BEATS];
+static size_t beat_count;
+
+// What the pipeline reported
+static double detected[MAX_BEATS];      // Beat (peak) times
+static double detected_at[MAX_BEATS];   // When the beat event fired
+static size_t detected_count;
+static double estimate_time[MAX_BEATS];
+static double estimate_bpm[MAX_BEATS];
+static size_t estimate_count;
+
+// Heart rate of the profile at time t
+static double profile_bpm(scenario_t const* s, double t, double seconds) {
+  if (s->step_s > 0) {
+    return (t < s->step_s) ? s->bpm_start : s->bpm_end;
+  }
+  return s->bpm_start + (s->bpm_end - s->bpm_start) * t / seconds;
+}
+
+// True beat times. Ectopic beats come 35% early with a smaller pulse and
+// are followed by a compensatory pause.
+static void synth_beats(scenario_t const* s, double seconds, uint32_t* state) {
+  double t = 0.5;
+  beat_count = 0;
+  while (t < seconds && beat_count < MAX_BEATS) {
+    double rr = 60.0 / profile_bpm(s, t, seconds) * (1.0 + s->rr_jitter * ppg_synth_gaussian(state));
+    bool ectopic = s->ectopic_every > 0 && (int)(beat_count % (size_t)s->ectopic_every) == s->ectopic_every - 1;
+    beats[beat_count] = t + (ectopic ? -0.35 * rr : 0);
+    beat_amplitude[beat_count] = ectopic ? 0.6 : 1.0;
+    beat_count++;
+    t += rr;
+  }
+}
+
+// Motion artifact bursts: 1.5 s every 15 s of a few random low-frequency
+// swings under a smooth envelope, starting after 10 s
+static double motion_at(scenario_t const* s, double t) {
+  if (s->motion_counts == 0 || t < 10) {
+    return 0;
+  }
+  double phase = fmod(t - 10, 15.0);
+  if (phase > 1.5) {
+    return 0;
+  }
+  uint32_t burst = (uint32_t)((t - 10) / 15.0) * 2654435761u + s->seed;
+  double value = 0;
+  for (int k = 0; k < 3; k++) {
+    double hz = 1.0 + 1.5 * (ppg_synth_noise(&burst) + 1.0);
+    double offset = M_PI * ppg_synth_noise(&burst);
+    value += sin(2 * M_PI * hz * t + offset) / 3.0;
+  }
+  return s->motion_counts * sin(M_PI * phase / 1.5) * value;
+}
+
+// Fill samples[] with the scenario's trace, clipped and quantized like the
+// SAADC
+static size_t synth_trace(scenario_t const* s, double seconds) {
+  uint32_t state = s->seed * 7919u + 1;
+  synth_beats(s, seconds, &state);
+
+  size_t count = (size_t)(seconds * 1e6 / SAMPLE_US);
+  size_t next = 0;
+  for (size_t i = 0; i < count; i++) {
+    double t = i * SAMPLE_US / 1e6;
+    while (next < beat_count && beats[next] < t - 1.0) {
+      next++;
+    }
+    double value = s->baseline;
+    for (size_t b = next; b < beat_count && beats[b] < t + 1.0; b++) {
+      value += s->amplitude * beat_amplitude[b] * ppg_synth_pulse(t - beats[b]);
+    }
+    value += s->wander_counts * sin(2 * M_PI * 0.25 * t);
+    value += motion_at(s, t);
+    value += s->noise_counts * ppg_synth_gaussian(&state);
+    value = fmin(fmax(round(value), 0), ADC_MAX);
+    samples[i] = (float)value;
+  }
+  return count;
+}
+
+// Run the pipeline over the trace, recording beats and confident estimates
+static double run_pipeline(size_t count, double* coverage) {
+  pulse_pipeline_t pipeline;
+  pulse_pipeline_init(&pipeline);
+  detected_count = 0;
+  estimate_count = 0;
+  size_t settled = 0;
+  size_t confident = 0;
+
+  double start = ppg_synth_now_ns();
+  for (size_t i = 0; i < count; i++) {
+    uint32_t time_us = (uint32_t)(i * SAMPLE_US);
+    uint8_t events = pulse_pipeline_process(&pipeline, samples[i], time_us);
+    if ((events & PULSE_EVENT_BEAT) && detected_count < MAX_BEATS) {
+      detected[detected_count] = pipeline.beat_time_us / 1e6;
+      detected_at[detected_count++] = time_us / 1e6;
+    }
+    pulse_estimate_t const* e = &pipeline.estimate;
+    bool is_confident = e->bpm > 0 && e->confidence >= PULSE_MIN_CONFIDENCE;
+    if ((events & PULSE_EVENT_ESTIMATE) && is_confident && estimate_count < MAX_BEATS) {
+      estimate_time[estimate_count] = e->beat_time_us / 1e6;
+      estimate_bpm[estimate_count++] = e->bpm;
+    }
+    if (time_us >= PULSE_STABILIZATION_TIME_MS * 1000) {
+      settled++;
+      confident += is_confident;
+    }
+  }
+  double elapsed = ppg_synth_now_ns() - start;
+
+  *coverage = settled ? (double)confident / settled : 0;
+  return elapsed / count;
+}
+
+// Mean true rate over the TRUTH_WINDOW_S ending at t
+static double true_bpm(double t) {
+  size_t last = 0;
+  while (last + 1 < beat_count && beats[last + 1] <= t + 1e-3) {
+    last++;
+  }
+  size_t first = last;
+  while (first > 0 && beats[first - 1] >= beats[last] - TRUTH_WINDOW_S) {
+    first--;
+  }
+  if (last == first) {
+    return 0;
+  }
+  return 60.0 * (last - first) / (beats[last] - beats[first]);
+}
+
+static score_t score(double seconds) {
+  static bool matched[MAX_BEATS];
+  score_t s = {0};
+  double from = PULSE_STABILIZATION_TIME_MS / 1000.0;
+  double to = seconds - 1.0;
+
+  // Greedy matching of detections to the nearest unmatched true beat
+  memset(matched, 0, sizeof(matched));
+  size_t true_positive = 0, false_positive = 0, truth = 0;
+  double latency = 0;
+  size_t j = 0;
+  for (size_t i = 0; i < detected_count; i++) {
+    double d = detected[i];
+    if (d < from || d > to) {
+      continue;
+    }
+    while (j + 1 < beat_count && beats[j + 1] < d) {
+      j++;
+    }
+    long best = -1;
+    double best_error = MATCH_WINDOW_S;
+    for (size_t k = (j > 0) ? j - 1 : 0; k < beat_count && k <= j + 1; k++) {
+      double error = fabs(beats[k] - d);
+      if (!matched[k] && error <= best_error) {
+        best = (long)k;
+        best_error = error;
+      }
+    }
+    if (best >= 0) {
+      matched[best] = true;
+      true_positive++;
+      latency += detected_at[i] - beats[best];
+    } else {
+      false_positive++;
+    }
+  }
+  for (size_t k = 0; k < beat_count; k++) {
+    truth += beats[k] >= from && beats[k] <= to;
+  }
+
+  double error = 0;
+  size_t scored = 0;
+  for (size_t i = 0; i < estimate_count; i++) {
+    if (estimate_time[i] >= from && estimate_time[i] <= to) {
+      double reference = true_bpm(estimate_time[i]);
+      if (reference > 0) {
+        error += fabs(estimate_bpm[i] - reference);
+        scored++;
+      }
+    }
+  }
+
+  s.bpm_mae = scored ? error / scored : NAN;
+  s.sensitivity = truth ? (double)true_positive / truth : 0;
+  s.predictivity = (true_positive + false_positive) ? (double)true_positive / (true_positive + false_positive) : 0;
+  s.latency_ms = true_positive ? latency / true_positive * 1000 : NAN;
+  return s;
+}
+
+// Previous results, by scenario name
+static bool load_previous(const char* path, score_t* previous, bool* found) {
+  FILE* f = fopen(path, "r");
+  if (f == NULL) {
+    return false;
+  }
+  char line[256];
+  while (fgets(line, sizeof(line), f) != NULL) {
+    char name[64];
+    score_t s;
+    if (sscanf(line, "%63[^\t]\t%lf\t%lf\t%lf\t%lf\t%lf\t%lf", name, &s.bpm_mae, &s.coverage,
+               &s.sensitivity, &s.predictivity, &s.latency_ms, &s.ns_per_sample) != 7) {
+      continue;
+    }
+    for (size_t i = 0; i < SCENARIO_COUNT; i++) {
+      if (strcmp(name, scenarios[i].name) == 0) {
+        previous[i] = s;
+        found[i] = true;
+      }
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+static void save_results(const char* path, score_t const* results) {
+  FILE* f = fopen(path, "w");
+  if (f == NULL) {
+    perror(path);
+    return;
+  }
+  for (size_t i = 0; i < SCENARIO_COUNT; i++) {
+    score_t const* s = &results[i];
+    fprintf(f, "%s\t%.4f\t%.4f\t%.4f\t%.4f\t%.2f\t%.2f\n", scenarios[i].name, s->bpm_mae, s->coverage,
+            s->sensitivity, s->predictivity, s->latency_ms, s->ns_per_sample);
+  }
+  fclose(f);
+}
+
+static void print_header(const char* title) {
+  printf("%-22s %8s %7s %7s %7s %9s %7s\n", title, "bpm_mae", "cover%", "se%", "ppv%", "latency", "ns");
+}
+
+static void print_row(const char* name, score_t const* s, bool delta) {
+  const char* format = delta ? "%-22s %+8.2f %+7.1f %+7.1f %+7.1f %+7.0fms %+7.1f\n"
+                             : "%-22s %8.2f %7.1f %7.1f %7.1f %7.0fms %7.1f\n";
+  printf(format, name, s->bpm_mae, s->coverage * 100, s->sensitivity * 100, s->predictivity * 100,
+         s->latency_ms, s->ns_per_sample);
+}
+
+int main(int argc, char** argv) {
+  double seconds = 120;
+  const char* results_path = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      seconds = fmin(atof(argv[++i]), MAX_SECONDS);
+    } else {
+      results_path = argv[i];
+    }
+  }
+
+  static score_t results[SCENARIO_COUNT];
+  print_header("scenario");
+  for (size_t i = 0; i < SCENARIO_COUNT; i++) {
+    size_t count = synth_trace(&scenarios[i], seconds);
+    double coverage;
+    double ns = run_pipeline(count, &coverage);
+    results[i] = score(seconds);
+    results[i].coverage = coverage;
+    results[i].ns_per_sample = ns;
+    print_row(scenarios[i].name, &results[i], false);
+  }
+
+  if (results_path != NULL) {
+    static score_t previous[SCENARIO_COUNT];
+    static bool found[SCENARIO_COUNT];
+    if (load_previous(results_path, previous, found)) {
+      printf("\n");
+      print_header("change since last run");
+      for (size_t i = 0; i < SCENARIO_COUNT; i++) {
+        if (!found[i]) {
+          continue;
+        }
+        score_t delta = {
+          results[i].bpm_mae - previous[i].bpm_mae,
+          results[i].coverage - previous[i].coverage,
+          results[i].sensitivity - previous[i].sensitivity,
+          results[i].predictivity - previous[i].predictivity,
+          results[i].latency_ms - previous[i].latency_ms,
+          results[i].ns_per_sample - previous[i].ns_per_sample,
+        };
+        print_row(scenarios[i].name, &delta, true);
+      }
+    }
+    save_results(results_path, results);
+  }
+
+  // The clean trace must always be tracked
+  score_t const* clean = &results[0];
+  bool ok = clean->sensitivity > 0.98 && clean->predictivity > 0.98 && clean->bpm_mae < 2;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "ppg_synth.h"
+#ifdef PPG_SYNTH_HAVE_CYCLES
+#include <x86intrin.h>
+#endif
+
+// Start of the first beat of a steady pulse train
+#define STEADY_FIRST_BEAT_S 0.1
+
+// Deterministic 24-bit pseudo-random value (linear congruential generator)
+uint32_t ppg_synth_rand(uint32_t* state) {
+  *state = *state * 1664525u + 1013904223u;
+  return *state >> 8;
+}
+
+// Deterministic uniform noise in [-1, 1]
+double ppg_synth_noise(uint32_t* state) {
+  return ppg_synth_rand(state) / 8388608.0 - 1.0;
+}
+
+// Deterministic standard normal noise
+double ppg_synth_gaussian(uint32_t* state) {
+  double u = (ppg_synth_noise(state) + 1.0) / 2.0 * 0.999999 + 1e-7;
+  double v = (ppg_synth_noise(state) + 1.0) / 2.0;
+  return sqrt(-2.0 * log(u)) * cos(2 * M_PI * v);
+}
+
+// One beat t seconds after its systolic peak: the peak plus a dicrotic wave
+// 300 ms later, 1.0 high at the peak
+double ppg_synth_pulse(double t) {
+  return exp(-pow(t / 0.07, 2)) + 0.35 * exp(-pow((t - 0.3) / 0.1, 2));
+}
+
+// Pulse train at a steady rate, including the tails of the neighbouring
+// beats
+double ppg_synth_steady(double t, double bpm) {
+  double period = 60.0 / bpm;
+  double since = fmod(t + period - STEADY_FIRST_BEAT_S, period);
+  return ppg_synth_pulse(since) + ppg_synth_pulse(since + period) + ppg_synth_pulse(since - period);
+}
+
+// Monotonic wall-clock time
+double ppg_synth_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// CPU cycle counter, or 0 where there is none
+uint64_t ppg_synth_cycles(void) {
+#ifdef PPG_SYNTH_HAVE_CYCLES
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
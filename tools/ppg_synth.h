@@ -0,0 +1,27 @@
+// Synthetic PPG Signals for the Host Tools
+//
+// The deterministic noise generator, pulse waveform and clocks shared by the
+// benchmarks, the scoreboard and the host tests, so every tool generates the
+// same signal from the same seed. Host only.
+
+#pragma once
+#include <stdint.h>
+
+// __rdtsc() is available, so ppg_synth_cycles() counts CPU cycles
+#if defined(__x86_64__) || defined(__i386__)
+#define PPG_SYNTH_HAVE_CYCLES 1
+#endif
+
+uint32_t ppg_synth_rand(uint32_t* state);
+
+double ppg_synth_noise(uint32_t* state);
+
+double ppg_synth_gaussian(uint32_t* state);
+
+double ppg_synth_pulse(double t);
+
+double ppg_synth_steady(double t, double bpm);
+
+double ppg_synth_now_ns(void);
+
+uint64_t ppg_synth_cycles(void);
@@ -0,0 +1,172 @@
+// Host round-trip test for the session log reading codec
+//
+// Encodes reading series with src/session_codec.c the way the session log
+// fills a flash record (first reading verbatim, then deltas until the next
+// reading might not fit), decodes every record again and checks each reading
+// comes back exactly. Series cover a steady 3 s log, BPM dropping to 0 and
+// back, missing temperatures, time jumps, and every pair of extreme values.
+// Also checks the SESSION_CODEC_MAX_BYTES bound and that truncated or
+// corrupt deltas are rejected rather than read past the record.
+//
+// Build: gcc -std=gnu99 -O2 -Wall -Iinclude -o session_codec_test tools/session_codec_test.c tools/ppg_synth.c src/session_codec.c -lm
+// Usage: ./session_codec_test
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ppg_synth.h"
+#include "session_codec.h"
+
+// Delta bytes in one flash record, as in src/session_log.c
+#define RECORD_PAYLOAD_BYTES 992
+
+#define MAX_READINGS 20000
+
+static session_reading_t series[MAX_READINGS];
+static session_reading_t decoded[MAX_READINGS];
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void) {
+  return ppg_synth_rand(&rng_state);
+}
+
+// Encode a series into records and decode them back. Returns the number of
+// readings that differ; reports the encoded size.
+static uint32_t round_trip(session_reading_t const* in, uint32_t count, uint32_t* bytes, uint32_t* records,
+                           uint32_t* max_bytes) {
+  uint8_t payload[RECORD_PAYLOAD_BYTES];
+  uint32_t errors = 0;
+  uint32_t out = 0;
+  *bytes = 0;
+  *records = 0;
+  *max_bytes = 0;
+
+  uint32_t i = 0;
+  while (i < count) {
+    // Fill one record
+    session_reading_t first = in[i];
+    uint16_t length = 0;
+    uint16_t readings = 1;
+    for (i++; i < count && length + SESSION_CODEC_MAX_BYTES <= RECORD_PAYLOAD_BYTES; i++, readings++) {
+      uint8_t* end = session_codec_put(&payload[length], &in[i - 1], &in[i]);
+      uint32_t used = end - &payload[length];
+      if (used > *max_bytes) {
+        *max_bytes = used;
+      }
+      length += used;
+    }
+    *bytes += sizeof(session_reading_t) + length;
+    (*records)++;
+
+    // Decode it
+    session_reading_t reading = first;
+    decoded[out++] = reading;
+    uint8_t const* p = payload;
+    for (uint16_t r = 1; r < readings; r++) {
+      p = session_codec_get(p, payload + length, &reading);
+      if (p == NULL) {
+        return count;
+      }
+      decoded[out++] = reading;
+    }
+    if (p != payload + length) {
+      errors++;  // Trailing bytes left over
+    }
+  }
+
+  for (uint32_t r = 0; r < count; r++) {
+    if (memcmp(&in[r], &decoded[r], sizeof(session_reading_t)) != 0) {
+      errors++;
+    }
+  }
+  return errors;
+}
+
+static bool report(char const* name, session_reading_t const* in, uint32_t count) {
+  uint32_t bytes, records, max_bytes;
+  uint32_t errors = round_trip(in, count, &bytes, &records, &max_bytes);
+  bool ok = errors == 0 && max_bytes <= SESSION_CODEC_MAX_BYTES;
+  printf("%-12s %6u readings %4u records %7.2f bytes/reading  max %2u  %u wrong: %s\n", name, count, records,
+         (double)bytes / count, max_bytes, errors, ok ? "ok" : "FAILED");
+  return ok;
+}
+
+// Check truncated and over-long deltas are rejected without reading past end
+static bool check_rejects(void) {
+  session_reading_t prev = {100, 72, 3310};
+  session_reading_t next = {0xFFFFFFF0u, 0, SESSION_LOG_NO_TEMP};
+  uint8_t buffer[SESSION_CODEC_MAX_BYTES];
+  uint8_t* end = session_codec_put(buffer, &prev, &next);
+  uint32_t length = end - buffer;
+
+  bool ok = true;
+  for (uint32_t cut = 0; cut < length; cut++) {
+    session_reading_t reading = prev;
+    if (session_codec_get(buffer, buffer + cut, &reading) != NULL ||
+        memcmp(&reading, &prev, sizeof(prev)) != 0) {
+      ok = false;
+    }
+  }
+  uint8_t endless[8];
+  memset(endless, 0xFF, sizeof(endless));
+  session_reading_t reading = prev;
+  if (session_codec_get(endless, endless + sizeof(endless), &reading) != NULL) {
+    ok = false;
+  }
+  printf("%-12s %u truncations and an over-long varint rejected: %s\n", "rejects", length, ok ? "ok" : "FAILED");
+  return ok;
+}
+
+int main(void) {
+  bool ok = true;
+  uint32_t n;
+
+  // Steady: a reading every 3 s, BPM and temperature drifting slowly
+  session_reading_t r = {0, 72, 3300};
+  for (n = 0; n < MAX_READINGS; n++) {
+    r.time_s += 3;
+    r.bpm = (uint16_t)(r.bpm + (int)(rng() % 5) - 2);
+    r.temp_centi = (int16_t)(r.temp_centi + (int)(rng() % 7) - 3);
+    series[n] = r;
+  }
+  ok &= report("steady", series, n);
+
+  // Pulse lost and found, temperature missing at times, late readings
+  r = (session_reading_t){0, 0, SESSION_LOG_NO_TEMP};
+  for (n = 0; n < MAX_READINGS; n++) {
+    r.time_s += (rng() % 50 == 0) ? 3 + rng() % 600 : 3;
+    r.bpm = (rng() % 20 == 0) ? 0 : 40 + rng() % 160;
+    r.temp_centi = (rng() % 30 == 0) ? SESSION_LOG_NO_TEMP : (int16_t)(2500 + rng() % 1500);
+    series[n] = r;
+  }
+  ok &= report("dropouts", series, n);
+
+  // Uniformly random fields, including time going backwards and wrapping
+  for (n = 0; n < MAX_READINGS; n++) {
+    series[n] = (session_reading_t){rng() ^ (rng() << 24), (uint16_t)rng(), (int16_t)rng()};
+  }
+  ok &= report("random", series, n);
+
+  // Every pair of extreme values, in both orders
+  static const uint32_t times[] = {0, 1, 0x7FFFFFFFu, 0x80000000u, 0xFFFFFFFFu};
+  static const uint16_t bpms[] = {0, 1, 0x7FFF, 0x8000, 0xFFFF};
+  static const int16_t temps[] = {INT16_MIN, -1, 0, 1, INT16_MAX};
+  n = 0;
+  for (int t = 0; t < 5; t++) {
+    for (int b = 0; b < 5; b++) {
+      for (int c = 0; c < 5; c++) {
+        for (int t2 = 0; t2 < 5; t2++) {
+          series[n++] = (session_reading_t){times[t], bpms[b], temps[c]};
+          series[n++] = (session_reading_t){times[t2], bpms[4 - b], temps[4 - c]};
+        }
+      }
+    }
+  }
+  ok &= report("extremes", series, n);
+
+  ok &= check_rejects();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,226 @@
+// Host stress test and benchmark for the lock-free SPSC queues
+//
+// Runs include/spsc_queue.h with producers and the consumer on separate
+// threads. The stress test pushes numbered items whose payload is derived
+// from the number, through a small ring so it is full and empty often, and
+// checks the consumer sees every item once, in order, intact. A second test
+// feeds two typed queues from two producer threads and drains both through
+// one dispatcher, as the main loop does. The benchmark then reports
+// events/second through one queue for several ring sizes.
+//
+// Build: gcc -std=gnu99 -O2 -Wall -Iinclude -pthread -o spsc_stress tools/spsc_stress.c
+// Usage: ./spsc_stress [million items]
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "spsc_queue.h"
+
+// Shaped like a pulse sensor scan, so a torn copy is detectable
+typedef struct {
+  uint32_t seq;
+  uint32_t time_us;
+  uint16_t samples[4];
+} scan_item_t;
+
+// Shaped like a beat event
+typedef struct {
+  uint32_t seq;
+  float bpm;
+} beat_item_t;
+
+SPSC_QUEUE_DEFINE(small_queue, scan_item_t, 8)
+SPSC_QUEUE_DEFINE(scan_queue, scan_item_t, 256)
+SPSC_QUEUE_DEFINE(beat_queue, beat_item_t, 16)
+SPSC_QUEUE_DEFINE(bench16_queue, uint32_t, 16)
+SPSC_QUEUE_DEFINE(bench256_queue, uint32_t, 256)
+SPSC_QUEUE_DEFINE(bench4096_queue, uint32_t, 4096)
+
+static uint32_t item_count = 10 * 1000 * 1000;
+
+static double now_s(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static scan_item_t make_scan(uint32_t seq) {
+  scan_item_t item = {seq, seq * 2000u, {0}};
+  for (int i = 0; i < 4; i++) {
+    item.samples[i] = (uint16_t)(seq * 7u + (uint32_t)i * 1031u);
+  }
+  return item;
+}
+
+static bool scan_intact(scan_item_t const* item, uint32_t seq) {
+  scan_item_t expected = make_scan(seq);
+  if (item->seq != seq || item->time_us != expected.time_us) {
+    return false;
+  }
+  for (int i = 0; i < 4; i++) {
+    if (item->samples[i] != expected.samples[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Push until accepted, yielding while full (the host may have one core)
+#define PUSH_WAIT(name, q, item)       \
+  while (!name##_push((q), (item))) {  \
+    sched_yield();                     \
+  }
+
+// Stress test: one producer, one consumer, a ring of eight
+
+static small_queue_t small;
+
+static void* small_producer(void* arg) {
+  for (uint32_t seq = 0; seq < item_count; seq++) {
+    scan_item_t item = make_scan(seq);
+    PUSH_WAIT(small_queue, &small, &item);
+  }
+  return NULL;
+}
+
+static bool stress_single(void) {
+  pthread_t producer;
+  pthread_create(&producer, NULL, small_producer, NULL);
+
+  uint32_t errors = 0;
+  uint32_t empty = 0;
+  for (uint32_t seq = 0; seq < item_count;) {
+    scan_item_t item;
+    if (!small_queue_pop(&small, &item)) {
+      empty++;
+      sched_yield();
+      continue;
+    }
+    if (!scan_intact(&item, seq)) {
+      errors++;
+    }
+    seq++;
+  }
+  pthread_join(producer, NULL);
+
+  bool ok = errors == 0 && small_queue_count(&small) == 0;
+  printf("single queue:   %u items, %u out of order or torn, full %u times, empty %u times: %s\n",
+         item_count, errors, small.dropped, empty, ok ? "ok" : "FAILED");
+  return ok;
+}
+
+// Dispatcher test: two producers, two typed queues, one consumer
+
+static scan_queue_t scans;
+static beat_queue_t beats;
+static spsc_dispatcher_t dispatcher;
+static uint32_t next_scan = 0;
+static uint32_t next_beat = 0;
+static uint32_t dispatch_errors = 0;
+
+static void handle_scan(scan_item_t const* item) {
+  if (!scan_intact(item, next_scan)) {
+    dispatch_errors++;
+  }
+  next_scan++;
+}
+
+static void handle_beat(beat_item_t const* item) {
+  if (item->seq != next_beat || item->bpm != (float)(item->seq % 200)) {
+    dispatch_errors++;
+  }
+  next_beat++;
+}
+
+SPSC_QUEUE_DRAIN(drain_scans, scan_queue, scans, handle_scan)
+SPSC_QUEUE_DRAIN(drain_beats, beat_queue, beats, handle_beat)
+
+static void* scan_producer(void* arg) {
+  for (uint32_t seq = 0; seq < item_count; seq++) {
+    scan_item_t item = make_scan(seq);
+    PUSH_WAIT(scan_queue, &scans, &item);
+  }
+  return NULL;
+}
+
+static void* beat_producer(void* arg) {
+  // One beat for every 400 scans, as at 75 BPM
+  for (uint32_t seq = 0; seq < item_count / 400; seq++) {
+    beat_item_t item = {seq, (float)(seq % 200)};
+    PUSH_WAIT(beat_queue, &beats, &item);
+  }
+  return NULL;
+}
+
+static bool stress_dispatch(void) {
+  spsc_dispatcher_add(&dispatcher, drain_beats);
+  spsc_dispatcher_add(&dispatcher, drain_scans);
+
+  pthread_t producers[2];
+  pthread_create(&producers[0], NULL, scan_producer, NULL);
+  pthread_create(&producers[1], NULL, beat_producer, NULL);
+
+  while (next_scan < item_count || next_beat < item_count / 400) {
+    if (spsc_dispatch(&dispatcher, 8) == 0) {
+      sched_yield();
+    }
+  }
+  pthread_join(producers[0], NULL);
+  pthread_join(producers[1], NULL);
+
+  bool ok = dispatch_errors == 0 && spsc_dispatch(&dispatcher, 8) == 0;
+  printf("dispatcher:     %u scans, %u beats, %u out of order or torn: %s\n",
+         next_scan, next_beat, dispatch_errors, ok ? "ok" : "FAILED");
+  return ok;
+}
+
+// Throughput benchmark: producer thread to consumer thread, one word each
+
+#define DEFINE_BENCH(name)                                    \
+  static name##_t name##_ring;                                \
+  static void* name##_producer(void* arg) {                   \
+    for (uint32_t seq = 0; seq < item_count; seq++) {         \
+      PUSH_WAIT(name, &name##_ring, &seq);                    \
+    }                                                         \
+    return NULL;                                              \
+  }                                                           \
+  static double name##_run(bool* ok) {                        \
+    double start = now_s();                                   \
+    pthread_t producer;                                       \
+    pthread_create(&producer, NULL, name##_producer, NULL);   \
+    uint32_t value;                                           \
+    for (uint32_t seq = 0; seq < item_count;) {               \
+      if (name##_pop(&name##_ring, &value)) {                 \
+        *ok &= value == seq++;                                \
+      } else {                                                \
+        sched_yield();                                        \
+      }                                                       \
+    }                                                         \
+    pthread_join(producer, NULL);                             \
+    return item_count / (now_s() - start);                    \
+  }
+
+DEFINE_BENCH(bench16_queue)
+DEFINE_BENCH(bench256_queue)
+DEFINE_BENCH(bench4096_queue)
+
+int main(int argc, char** argv) {
+  if (argc > 1) {
+    item_count = (uint32_t)(atof(argv[1]) * 1e6);
+  }
+
+  bool ok = stress_single();
+  ok &= stress_dispatch();
+
+  printf("\n%-8s %14s\n", "ring", "events/s");
+  printf("%-8d %14.0f\n", 16, bench16_queue_run(&ok));
+  printf("%-8d %14.0f\n", 256, bench256_queue_run(&ok));
+  printf("%-8d %14.0f\n", 4096, bench4096_queue_run(&ok));
+  return ok ? 0 : 1;
+}
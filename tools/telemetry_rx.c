@@ -0,0 +1,440 @@
+// Host receiver for the binary telemetry stream
+//
+// Decodes COBS/CRC16 frames from a serial port and prints one line per packet
+// plus per-second link statistics. With --simulate it creates a pseudo-terminal,
+// feeds it synthetic frames from a child process (including corrupted and
+// dropped ones) and decodes them, so the receiver can be checked without a board.
+// Frames are built with the firmware's own encoder (src/telemetry_frame.c).
+//
+// Build: gcc -std=gnu99 -O2 -Wall -Iinclude -o telemetry_rx tools/telemetry_rx.c src/ppg_codec.c src/telemetry_frame.c -lm
+// Usage: ./telemetry_rx /dev/ttyUSB0 [-v] [-o samples.txt]
+//        ./telemetry_rx --pty [-v]       (prints the pty path to write frames to)
+//        ./telemetry_rx --simulate [-v]
+//
+// -o saves every raw PPG sample, one per line, for use with codec_bench.
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ppg_codec.h"
+#include "telemetry_frame.h"
+
+// Packet types, must match include/telemetry.h
+enum {
+  PKT_RAW_SAMPLES = 0x01,
+  PKT_RED_IR      = 0x02,
+  PKT_BEAT        = 0x03,
+  PKT_VITALS      = 0x04,
+  PKT_METRICS     = 0x05,
+  PKT_RAW_CODED   = 0x06,
+  PKT_SESSION     = 0x07,
+};
+
+#define MAX_FRAME 1024
+
+// Link statistics
+typedef struct {
+  uint64_t bytes;
+  uint64_t frames;
+  uint64_t crc_errors;
+  uint64_t framing_errors;
+  uint64_t lost;
+  uint64_t samples;
+  uint64_t sample_errors;
+  bool have_seq;
+  uint8_t last_seq;
+} rx_stats_t;
+
+static bool verbose = false;
+static bool simulating = false;
+static FILE* sample_file = NULL;
+
+static double simulated_sample(uint32_t index);
+
+// Decode one COBS frame (without the delimiter). Returns -1 if malformed.
+static int cobs_decode(uint8_t const* in, size_t length, uint8_t* out) {
+  size_t read = 0;
+  size_t written = 0;
+  while (read < length) {
+    uint8_t code = in[read++];
+    if (code == 0 || read + code - 1 > length) {
+      return -1;
+    }
+    for (uint8_t i = 1; i < code; i++) {
+      out[written++] = in[read++];
+    }
+    if (code < 0xFF && read < length) {
+      out[written++] = 0;
+    }
+  }
+  return (int)written;
+}
+
+static uint16_t get_u16(uint8_t const* p) {
+  return p[0] | (p[1] << 8);
+}
+
+static uint32_t get_u32(uint8_t const* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Record raw PPG samples (and check them against the simulated board)
+static void handle_samples(rx_stats_t* stats, uint32_t index, int32_t const* samples, size_t count) {
+  stats->samples += count;
+  for (size_t i = 0; i < count; i++) {
+    if (simulating && samples[i] != (int32_t)simulated_sample(index + i)) {
+      stats->sample_errors++;
+    }
+    if (sample_file != NULL) {
+      fprintf(sample_file, "%d\n", samples[i]);
+    }
+  }
+  if (verbose) {
+    printf("raw index=%u count=%zu first=%d\n", index, count, count ? samples[0] : 0);
+  }
+}
+
+// Print one decoded packet
+static void handle_packet(rx_stats_t* stats, uint8_t type, uint8_t const* p, size_t length) {
+  int32_t samples[PPG_CODEC_FRAME_SAMPLES];
+  uint16_t count;
+
+  switch (type) {
+    case PKT_RAW_SAMPLES:
+      if (length >= 4) {
+        count = (length - 4) / 2;
+        if (count > PPG_CODEC_FRAME_SAMPLES) {
+          count = PPG_CODEC_FRAME_SAMPLES;
+        }
+        for (uint16_t i = 0; i < count; i++) {
+          samples[i] = get_u16(p + 4 + 2 * i);
+        }
+        handle_samples(stats, get_u32(p), samples, count);
+      }
+      break;
+    case PKT_RAW_CODED:
+      if (length > 4 && ppg_decode_frame(p + 4, length - 4, 12, samples, &count) > 0) {
+        handle_samples(stats, get_u32(p), samples, count);
+      } else {
+        stats->framing_errors++;
+      }
+      break;
+    case PKT_RED_IR:
+      if (length >= 4 && verbose) {
+        printf("red_ir index=%u count=%zu\n", get_u32(p), (length - 4) / 8);
+      }
+      break;
+    case PKT_BEAT:
+      if (length == 9) {
+        uint16_t bpm = get_u16(p + 4);
+        uint16_t band = get_u16(p + 6);
+        printf("beat t=%u us bpm=%u.%u +/-%u.%u confidence=%u\n", get_u32(p), bpm / 10, bpm % 10,
+               band / 10, band % 10, p[8]);
+      }
+      break;
+    case PKT_VITALS:
+      if (length == 7) {
+        int16_t temp = (int16_t)get_u16(p + 4);
+        printf("vitals bpm=%u spo2=%u.%u%% temp=%d.%02d C quality=%u\n", get_u16(p),
+               get_u16(p + 2) / 10, get_u16(p + 2) % 10, temp / 100, abs(temp % 100), p[6]);
+      }
+      break;
+    case PKT_METRICS:
+      printf("metrics");
+      for (size_t i = 0; i + 5 <= length; i += 5) {
+        printf(" %u=%u", p[i], get_u32(p + i + 1));
+      }
+      printf("\n");
+      break;
+    case PKT_SESSION:
+      if (length >= 6 && length == 6 + (length - 6) / 8 * 8) {
+        if (length == 6) {
+          printf("session %u exported, %u readings\n", get_u16(p), get_u32(p + 2));
+        }
+        for (size_t i = 6; i < length; i += 8) {
+          int16_t temp = (int16_t)get_u16(p + i + 6);
+          printf("session %u reading %zu t=%u s bpm=%u", get_u16(p), get_u32(p + 2) + (i - 6) / 8,
+                 get_u32(p + i), get_u16(p + i + 4));
+          if (temp == INT16_MIN) {
+            printf(" temp=--\n");
+          } else {
+            printf(" temp=%s%d.%02d C\n", temp < 0 ? "-" : "", abs(temp) / 100, abs(temp) % 100);
+          }
+        }
+      } else {
+        stats->framing_errors++;
+      }
+      break;
+    default:
+      printf("unknown packet type 0x%02X (%zu bytes)\n", type, length);
+      break;
+  }
+}
+
+// Validate a COBS frame and dispatch its packet
+static void handle_frame(rx_stats_t* stats, uint8_t const* frame, size_t length) {
+  uint8_t decoded[MAX_FRAME];
+  int n = cobs_decode(frame, length, decoded);
+  if (n < 4) {
+    stats->framing_errors++;
+    return;
+  }
+  uint16_t crc = telemetry_crc16(decoded, n - 2, 0xFFFF);
+  if (crc != get_u16(&decoded[n - 2])) {
+    stats->crc_errors++;
+    return;
+  }
+
+  uint8_t seq = decoded[1];
+  if (stats->have_seq) {
+    stats->lost += (uint8_t)(seq - stats->last_seq - 1);
+  }
+  stats->have_seq = true;
+  stats->last_seq = seq;
+  stats->frames++;
+  handle_packet(stats, decoded[0], &decoded[2], n - 4);
+}
+
+static void print_stats(rx_stats_t const* stats, double seconds) {
+  fprintf(stderr, "[%.1f s] %llu frames, %.1f kB/s, %.0f samples/s, %llu lost, %llu crc errors, %llu framing errors\n",
+          seconds, (unsigned long long)stats->frames, stats->bytes / seconds / 1000.0,
+          stats->samples / seconds, (unsigned long long)stats->lost,
+          (unsigned long long)stats->crc_errors, (unsigned long long)stats->framing_errors);
+  if (simulating) {
+    fprintf(stderr, "  %llu samples, %llu wrong\n", (unsigned long long)stats->samples,
+            (unsigned long long)stats->sample_errors);
+  }
+}
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Receive and decode frames until end of input
+static rx_stats_t receive(int fd) {
+  rx_stats_t stats = {0};
+  uint8_t frame[MAX_FRAME];
+  size_t frame_length = 0;
+  uint8_t buffer[4096];
+  double start = now_seconds();
+  double last_report = start;
+
+  while (1) {
+    ssize_t n = read(fd, buffer, sizeof(buffer));
+    if (n <= 0) {
+      break;
+    }
+    stats.bytes += n;
+    for (ssize_t i = 0; i < n; i++) {
+      if (buffer[i] == 0) {
+        if (frame_length > 0) {
+          handle_frame(&stats, frame, frame_length);
+        }
+        frame_length = 0;
+      } else if (frame_length < sizeof(frame)) {
+        frame[frame_length++] = buffer[i];
+      } else {
+        stats.framing_errors++;  // Oversized, resynchronize on the next delimiter
+        frame_length = 0;
+      }
+    }
+    double now = now_seconds();
+    if (now - last_report >= 1.0) {
+      print_stats(&stats, now - start);
+      last_report = now;
+    }
+  }
+  print_stats(&stats, now_seconds() - start);
+  return stats;
+}
+
+// Encode and write one frame with the firmware's encoder (used by
+// --simulate). A corrupted frame has one payload bit flipped after encoding.
+static void send_frame(int fd, uint8_t type, uint8_t seq, uint8_t const* payload, size_t length,
+                       bool corrupt) {
+  uint8_t encoded[TELEMETRY_FRAME_MAX_BYTES(MAX_FRAME)];
+  size_t n = telemetry_frame_encode(encoded, type, seq, payload, length);
+  if (corrupt) {
+    // Skip the COBS code bytes and flip a data byte that stays non-zero
+    size_t code = 0;
+    for (size_t i = 1; i + 1 < n; i++) {
+      if (i == code + encoded[code]) {
+        code = i;
+      } else if (i > 3 && (encoded[i] ^ 0x40) != 0) {
+        encoded[i] ^= 0x40;
+        break;
+      }
+    }
+  }
+  if (write(fd, encoded, n) != (ssize_t)n) {
+    perror("write");
+  }
+}
+
+static void put_u16(uint8_t* out, uint16_t value) {
+  telemetry_put_u16(out, value);
+}
+
+static void put_u32(uint8_t* out, uint32_t value) {
+  telemetry_put_u32(out, value);
+}
+
+// Simulated 500 Hz PPG at 75 BPM
+static double simulated_sample(uint32_t index) {
+  return floor(2100 + 400 * sin(2 * M_PI * 1.25 * index * 0.002));
+}
+
+// Stand-in for the board: 2 s of PPG written to the pty, alternating plain
+// and codec packets. Frame 10 is corrupted and frame 20 is skipped to
+// exercise error counting.
+static void simulate_board(int fd) {
+  uint8_t seq = 0;
+  uint32_t index = 0;
+  for (int packet = 0; packet < 40; packet++, seq++) {
+    uint8_t payload[4 + PPG_CODEC_MAX_FRAME_BYTES(12)];
+    int32_t samples[25];
+    put_u32(payload, index);
+    for (int i = 0; i < 25; i++, index++) {
+      samples[i] = (int32_t)simulated_sample(index);
+      put_u16(&payload[4 + 2 * i], (uint16_t)samples[i]);
+    }
+    if (packet % 2 == 1) {
+      size_t length = ppg_encode_frame(samples, 25, 12, &payload[4], sizeof(payload) - 4);
+      if (packet != 20) {
+        send_frame(fd, PKT_RAW_CODED, seq, payload, 4 + length, packet == 11);
+      }
+    } else if (packet != 20) {
+      send_frame(fd, PKT_RAW_SAMPLES, seq, payload, 4 + 2 * 25, packet == 10);
+    }
+    if (packet % 16 == 15) {
+      uint8_t beat[9];
+      put_u32(beat, index * 2000);
+      put_u16(beat + 4, 750);
+      put_u16(beat + 6, 12);
+      beat[8] = 90;
+      send_frame(fd, PKT_BEAT, ++seq, beat, sizeof(beat), false);
+    }
+    usleep(50000);
+  }
+  uint8_t vitals[7];
+  put_u16(vitals, 75);
+  put_u16(vitals + 2, 0);
+  put_u16(vitals + 4, (uint16_t)3312);
+  vitals[6] = 100;
+  send_frame(fd, PKT_VITALS, seq, vitals, sizeof(vitals), false);
+}
+
+// Put a serial port in raw mode at 1 Mbaud
+static int open_serial(const char* path) {
+  int fd = open(path, O_RDONLY | O_NOCTTY);
+  if (fd < 0) {
+    perror(path);
+    exit(1);
+  }
+  struct termios tio;
+  tcgetattr(fd, &tio);
+  cfmakeraw(&tio);
+#ifdef B1000000
+  cfsetispeed(&tio, B1000000);
+#endif
+  tio.c_cc[VMIN] = 1;
+  tio.c_cc[VTIME] = 0;
+  tcsetattr(fd, TCSANOW, &tio);
+  return fd;
+}
+
+// Create a pseudo-terminal and return the master side
+static int open_pty(char* slave_path, size_t size) {
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+    perror("pty");
+    exit(1);
+  }
+  snprintf(slave_path, size, "%s", ptsname(master));
+
+  // Raw mode so 0x00 and control bytes pass through untouched
+  int slave = open(slave_path, O_RDWR | O_NOCTTY);
+  struct termios tio;
+  tcgetattr(slave, &tio);
+  cfmakeraw(&tio);
+  tcsetattr(slave, TCSANOW, &tio);
+  close(slave);
+  return master;
+}
+
+int main(int argc, char** argv) {
+  const char* source = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+    } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      sample_file = fopen(argv[++i], "w");
+      if (sample_file == NULL) {
+        perror(argv[i]);
+        return 1;
+      }
+    } else {
+      source = argv[i];
+    }
+  }
+  if (source == NULL) {
+    fprintf(stderr, "usage: %s <serial device> | --pty | --simulate [-v] [-o samples.txt]\n", argv[0]);
+    return 2;
+  }
+
+  if (strcmp(source, "--pty") == 0 || strcmp(source, "--simulate") == 0) {
+    char slave_path[128];
+    int master = open_pty(slave_path, sizeof(slave_path));
+    if (strcmp(source, "--pty") == 0) {
+      fprintf(stderr, "Write frames to %s\n", slave_path);
+      // Keep a writer open so the master does not see end of input early
+      int keep = open(slave_path, O_WRONLY | O_NOCTTY);
+      receive(master);
+      close(keep);
+      return 0;
+    }
+
+    // Open the slave before forking so the master never sees it closed early
+    simulating = true;
+    int slave = open(slave_path, O_WRONLY | O_NOCTTY);
+    pid_t child = fork();
+    if (child == 0) {
+      close(master);
+      simulate_board(slave);
+      tcdrain(slave);
+      close(slave);
+      _exit(0);
+    }
+    close(slave);
+
+    // Reading the master fails with EIO once the child closes the slave
+    rx_stats_t stats = receive(master);
+    waitpid(child, NULL, 0);
+    if (sample_file != NULL) {
+      fclose(sample_file);
+    }
+    bool ok = stats.frames == 40 && stats.crc_errors == 2 && stats.lost == 3 &&
+              stats.samples == 37 * 25 && stats.sample_errors == 0;
+    fprintf(stderr, "simulation %s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+  }
+
+  rx_stats_t stats = receive(open_serial(source));
+  if (sample_file != NULL) {
+    fclose(sample_file);
+  }
+  return stats.frames > 0 ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+// Host test for the multi-resolution rolling statistics
+//
+// Feeds src/trends.c three days of BPM and temperature readings every 3 s,
+// the way the firmware does, with gaps where the pulse is lost. Every so
+// often it queries spans resolved by each level (10 s, 1 min, 15 min and
+// 1 h buckets) and checks min, max, count and mean against the raw readings
+// the query should cover. Three days wraps every ring, the hourly one
+// included. Bucket means are rounded, so the mean may be off by one.
+//
+// Build: gcc -std=gnu99 -O2 -Wall -Iinclude -o trends_test tools/trends_test.c tools/ppg_synth.c src/trends.c -lm
+// Usage: ./trends_test
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ppg_synth.h"
+#include "trends.h"
+
+#define START_S      1234
+#define DURATION_S   (3 * 24 * 3600)
+#define PERIOD_S     3
+#define CHECK_EVERY  997
+
+#define MAX_READINGS (DURATION_S / PERIOD_S)
+
+// Bucket width and ring size of each level, as in include/trends.h
+static const uint32_t level_width[TRENDS_LEVELS] = {10, 60, 900, 3600};
+static const uint32_t level_size[TRENDS_LEVELS] = {30, 60, 96, 24};
+
+// Spans that select each level, plus ones longer than a ring holds
+static const uint32_t spans[] = {10, 60, 300, 360, 600, 3600, 5400, 14400, 21600, 86400, 200000};
+
+typedef struct {
+  uint32_t time_s;
+  int16_t value;
+} reading_t;
+
+static reading_t readings[TREND_METRIC_COUNT][MAX_READINGS];
+static uint32_t reading_count[TREND_METRIC_COUNT];
+
+static trends_t trends;
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void) {
+  return ppg_synth_rand(&rng_state);
+}
+
+// Level a query for span_s should use: the coarsest with six buckets in it
+static uint8_t query_level(uint32_t span_s) {
+  uint8_t level = 0;
+  while (level + 1 < TRENDS_LEVELS && span_s >= 6 * level_width[level + 1]) {
+    level++;
+  }
+  return level;
+}
+
+// Statistics of the raw readings a query for span_s at now_s should cover:
+// the level's bucket in progress plus as many closed buckets as the span
+// holds and the ring still has
+static bool expected_stats(trend_metric_t metric, uint32_t now_s, uint32_t span_s, trend_stat_t* result,
+                           int64_t* sum) {
+  uint8_t level = query_level(span_s);
+  uint32_t width = level_width[level];
+  uint32_t closed = (now_s - START_S) / width;
+  uint32_t wanted = span_s / width;
+  if (wanted > level_size[level]) {
+    wanted = level_size[level];
+  }
+  if (wanted > closed) {
+    wanted = closed;
+  }
+  uint32_t from = START_S + (closed - wanted) * width;
+
+  // Readings are in time order, so find the first one in the window
+  reading_t const* list = readings[metric];
+  uint32_t lo = 0;
+  uint32_t hi = reading_count[metric];
+  while (lo < hi) {
+    uint32_t mid = (lo + hi) / 2;
+    if (list[mid].time_s < from) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  *sum = 0;
+  result->count = 0;
+  result->min = INT16_MAX;
+  result->max = INT16_MIN;
+  for (uint32_t i = lo; i < reading_count[metric] && list[i].time_s <= now_s; i++) {
+    *sum += list[i].value;
+    result->count++;
+    if (list[i].value < result->min) {
+      result->min = list[i].value;
+    }
+    if (list[i].value > result->max) {
+      result->max = list[i].value;
+    }
+  }
+  if (result->count == 0) {
+    return false;
+  }
+  result->mean = (int16_t)(*sum / result->count);
+  return true;
+}
+
+// Check every span of one metric at now_s. Returns the number of failures.
+static uint32_t check(trend_metric_t metric, uint32_t now_s, uint32_t* checked) {
+  uint32_t failures = 0;
+  for (size_t s = 0; s < sizeof(spans) / sizeof(spans[0]); s++) {
+    trend_stat_t want;
+    trend_stat_t got;
+    int64_t sum;
+    bool want_found = expected_stats(metric, now_s, spans[s], &want, &sum);
+    bool got_found = trends_query(&trends, metric, spans[s], &got);
+    (*checked)++;
+
+    bool ok = want_found == got_found;
+    if (ok && want_found) {
+      ok = got.count == want.count && got.min == want.min && got.max == want.max &&
+           abs(got.mean - want.mean) <= 1;
+    }
+    if (!ok) {
+      if (failures == 0) {
+        printf("  t=%lu metric %d span %lu (level %u): expected", (unsigned long)(now_s - START_S), metric,
+               (unsigned long)spans[s], query_level(spans[s]));
+        if (want_found) {
+          printf(" n=%u min=%d max=%d mean=%d", want.count, want.min, want.max, want.mean);
+        } else {
+          printf(" nothing");
+        }
+        printf(", got");
+        if (got_found) {
+          printf(" n=%u min=%d max=%d mean=%d\n", got.count, got.min, got.max, got.mean);
+        } else {
+          printf(" nothing\n");
+        }
+      }
+      failures++;
+    }
+  }
+  return failures;
+}
+
+int main(void) {
+  uint32_t failures = 0;
+  uint32_t checked = 0;
+  trend_stat_t stat;
+
+  trends_init(&trends, START_S);
+  if (trends_query(&trends, TREND_BPM, 3600, &stat)) {
+    printf("FAIL: empty trends returned a result\n");
+    failures++;
+  }
+
+  int16_t bpm = 72;
+  int16_t temp = 3300;
+  uint32_t gap_until = 0;
+  uint32_t next_check = START_S + CHECK_EVERY;
+  for (uint32_t now = START_S; now < START_S + DURATION_S; now += PERIOD_S) {
+    // Lose the pulse now and then, for up to two hours
+    if (now >= gap_until && rng() % 2000 == 0) {
+      gap_until = now + rng() % 7200;
+    }
+
+    bpm = (int16_t)(bpm + (int)(rng() % 9) - 4);
+    if (bpm < 40 || bpm > 200) {
+      bpm = 72;
+    }
+    temp = (int16_t)(temp + (int)(rng() % 21) - 10);
+    if (temp < -4000 || temp > 4000) {
+      temp = 0;
+    }
+
+    // Same calls as publish_reading() in src/pulsesensor_util.c
+    trends_advance(&trends, now);
+    if (now >= gap_until) {
+      trends_add(&trends, now, TREND_BPM, bpm);
+      readings[TREND_BPM][reading_count[TREND_BPM]++] = (reading_t){now, bpm};
+    }
+    trends_add(&trends, now, TREND_TEMP, temp);
+    readings[TREND_TEMP][reading_count[TREND_TEMP]++] = (reading_t){now, temp};
+
+    if (now >= next_check) {
+      failures += check(TREND_BPM, now, &checked);
+      failures += check(TREND_TEMP, now, &checked);
+      failures += check(TREND_SPO2, now, &checked);
+      next_check += CHECK_EVERY;
+    }
+  }
+
+  printf("%lu BPM and %lu temperature readings, %lu queries checked\n", (unsigned long)reading_count[TREND_BPM],
+         (unsigned long)reading_count[TREND_TEMP], (unsigned long)checked);
+  for (uint8_t l = 0; l < TRENDS_LEVELS; l++) {
+    printf("  level %u: %lu buckets closed, ring of %u\n", l, (unsigned long)trends.closed[l], trends.filled[l]);
+  }
+  printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+  return failures == 0 ? 0 : 1;
+}